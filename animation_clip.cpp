@@ -0,0 +1,204 @@
+
+#include "animation_clip.h"
+#include "debug_break.h"
+#include <cmath>
+#include <algorithm>
+
+void atl::reduce_keyframes(region_type<const keyframe<float>> in_keys, float in_tolerance, std::vector<uint32_t> & out_kept_indices)
+{
+    const auto l_count = uint32_t(in_keys.size());
+    if(l_count == 0)
+        return;
+    const keyframe<float> * l_keys = in_keys.begin();
+    if(l_count <= 2)
+    {
+        for(uint32_t i = 0; i < l_count; ++i)
+            out_kept_indices.push_back(i);
+        return;
+    }
+
+    // Mark keys to keep, refining spans with an explicit stack instead of recursion:
+    std::vector<uint8_t> l_keep(l_count, 0);
+    l_keep[0] = l_keep[l_count - 1] = 1;
+    std::vector<std::pair<uint32_t, uint32_t>> l_spans;
+    l_spans.emplace_back(0, l_count - 1);
+    while(!l_spans.empty())
+    {
+        const auto l_span = l_spans.back();
+        l_spans.pop_back();
+        const keyframe<float> & l_first = l_keys[l_span.first];
+        const keyframe<float> & l_last = l_keys[l_span.second];
+        float l_worst_error = in_tolerance;
+        uint32_t l_worst_index = 0;
+        for(uint32_t i = l_span.first + 1; i < l_span.second; ++i)
+        {
+            float l_error = std::abs(l_first.interpolateTo(l_keys[i].t, l_last) - l_keys[i].v);
+            if(l_error > l_worst_error)
+            {
+                l_worst_error = l_error;
+                l_worst_index = i;
+            }
+        }
+        if(l_worst_index == 0)
+            continue;
+        l_keep[l_worst_index] = 1;
+        l_spans.emplace_back(l_span.first, l_worst_index);
+        l_spans.emplace_back(l_worst_index, l_span.second);
+    }
+
+    for(uint32_t i = 0; i < l_count; ++i)
+    {
+        if(l_keep[i])
+            out_kept_indices.push_back(i);
+    }
+}
+
+bool atl::encode_animation_channel(region_type<const keyframe<float>> in_keys, float in_frame_rate, float in_tolerance, animation_channel_encoding_type & out_encoding)
+{
+    std::vector<uint32_t> l_kept;
+    reduce_keyframes(in_keys, in_tolerance * 0.5f, l_kept);
+    const keyframe<float> * l_keys = in_keys.begin();
+
+    float l_min = l_keys[l_kept[0]].v;
+    float l_max = l_min;
+    for(auto l_index : l_kept)
+    {
+        l_min = std::min(l_min, l_keys[l_index].v);
+        l_max = std::max(l_max, l_keys[l_index].v);
+    }
+
+    // Rounding to the nearest step keeps quantization error within tolerance / 2.
+    // Cap the step count so a tiny tolerance cannot ask for more than 25 bits (the rounded count can reach 2^24).
+    const float l_min_step = (l_max - l_min) / float(1 << 24);
+    const bool l_tolerance_met = !(in_tolerance < l_min_step);
+    float l_step = std::max(in_tolerance, l_min_step);
+    if(l_step <= 0.f)
+        l_step = 1.f;
+    const auto l_max_quantized = uint32_t(std::lround((l_max - l_min) / l_step));
+
+    out_encoding.kept_frames.clear();
+    out_encoding.kept_values.clear();
+    uint32_t l_max_delta = 0;
+    for(auto l_index : l_kept)
+    {
+        const auto l_frame = uint32_t(std::max(0L, std::lround(l_keys[l_index].t * in_frame_rate)));
+        if(!out_encoding.kept_frames.empty())
+            l_max_delta = std::max(l_max_delta, l_frame - out_encoding.kept_frames.back());
+        out_encoding.kept_frames.push_back(l_frame);
+        out_encoding.kept_values.push_back(std::min(l_max_quantized, uint32_t(std::lround((l_keys[l_index].v - l_min) / l_step))));
+    }
+
+    out_encoding.first_frame = out_encoding.kept_frames[0];
+    out_encoding.value_min = l_min;
+    out_encoding.value_step = l_step;
+    out_encoding.time_bits = bits_required_for_integer(l_max_delta);
+    out_encoding.value_bits = bits_required_for_integer(l_max_quantized);
+    const uint32_t l_key_bits = out_encoding.value_bits + uint32_t(l_kept.size() - 1) * (out_encoding.time_bits + out_encoding.value_bits);
+    out_encoding.size_in_bytes = animation_channel_header_bytes + integer_divide_rounding_up(l_key_bits, uint32_t{8});
+    return l_tolerance_met;
+}
+
+atl::animation_channel_cursor_type::animation_channel_cursor_type(const bit_string_byte_type * in_channel_begin, const bit_string_byte_type * in_clip_end, float in_frame_rate)
+:
+internal_keys_begin(const_cast<bit_string_byte_type *>(in_channel_begin) + animation_channel_header_bytes),
+internal_clip_end(const_cast<bit_string_byte_type *>(in_clip_end)),
+internal_stream(simple_backing_buffer(const_cast<bit_string_byte_type *>(in_channel_begin), size_t(in_clip_end - in_channel_begin))),
+internal_frame_rate(in_frame_rate)
+{
+    uint32_t l_min_bits = 0, l_step_bits = 0;
+    internal_key_count = 0;
+    internal_first_frame = 0;
+    internal_time_bits = internal_value_bits = 0;
+    bit_string_read_bits(internal_stream, internal_key_count, 32);
+    bit_string_read_bits(internal_stream, internal_first_frame, 32);
+    bit_string_read_bits(internal_stream, l_min_bits, 32);
+    bit_string_read_bits(internal_stream, l_step_bits, 32);
+    bit_string_read_bits(internal_stream, internal_time_bits, 8);
+    bit_string_read_bits(internal_stream, internal_value_bits, 8);
+    std::memcpy(&internal_value_min, &l_min_bits, sizeof(float));
+    std::memcpy(&internal_value_step, &l_step_bits, sizeof(float));
+    restart();
+}
+
+void atl::animation_channel_cursor_type::restart()
+{
+    internal_stream = bit_string_wrap_backing_buffer(simple_backing_buffer(internal_keys_begin, size_t(internal_clip_end - internal_keys_begin)));
+    uint32_t l_quantized = 0;
+    bit_string_read_bits(internal_stream, l_quantized, internal_value_bits);
+    internal_prev_frame = internal_next_frame = internal_first_frame;
+    internal_prev_value = internal_next_value = internal_value_min + float(l_quantized) * internal_value_step;
+    internal_keys_read = 1;
+    if(internal_key_count > 1)
+        read_next_key();
+}
+
+void atl::animation_channel_cursor_type::read_next_key()
+{
+    uint32_t l_delta = 0, l_quantized = 0;
+    if(!bit_string_read_bits(internal_stream, l_delta, internal_time_bits) ||
+       !bit_string_read_bits(internal_stream, l_quantized, internal_value_bits))
+    {
+        // Truncated stream: hold the last good key.
+        internal_keys_read = internal_key_count;
+        return;
+    }
+    internal_next_frame = internal_prev_frame + l_delta;
+    internal_next_value = internal_value_min + float(l_quantized) * internal_value_step;
+    internal_keys_read++;
+}
+
+float atl::animation_channel_cursor_type::sample(float in_t)
+{
+    const float l_frame = in_t * internal_frame_rate;
+    // The previous key is only past the first key once a third key has been read:
+    if(l_frame < float(internal_prev_frame) && internal_keys_read > 2)
+        restart();
+    while(l_frame >= float(internal_next_frame) && internal_keys_read < internal_key_count)
+    {
+        internal_prev_frame = internal_next_frame;
+        internal_prev_value = internal_next_value;
+        read_next_key();
+    }
+    if(l_frame <= float(internal_prev_frame))
+        return internal_prev_value;
+    if(l_frame >= float(internal_next_frame))
+        return internal_next_value;
+    return atl::mapf_unclamped(l_frame, float(internal_prev_frame), float(internal_next_frame), internal_prev_value, internal_next_value);
+}
+
+atl::animation_clip_view_type::animation_clip_view_type(const bit_string_byte_type * in_data, size_t in_size)
+:
+internal_data(in_data),
+internal_size(in_size),
+internal_channel_count(0),
+internal_frame_rate(0.f),
+internal_valid(false)
+{
+    if(in_size < animation_clip_header_bytes(0))
+        return;
+    internal_channel_count = read_u32(0);
+    const uint32_t l_frame_rate_bits = read_u32(4);
+    std::memcpy(&internal_frame_rate, &l_frame_rate_bits, sizeof(float));
+    // Checked by division so that a corrupt channel_count cannot wrap the header size:
+    if(internal_channel_count > (in_size - animation_clip_header_bytes(0)) / 4)
+        return;
+    for(uint32_t i = 0; i < internal_channel_count; ++i)
+    {
+        if(size_t(read_u32(animation_clip_header_bytes(i))) + animation_channel_header_bytes > in_size)
+            return;
+    }
+    internal_valid = true;
+}
+
+uint32_t atl::animation_clip_view_type::read_u32(size_t in_byte_offset) const
+{
+    uint32_t l_value;
+    std::memcpy(&l_value, internal_data + in_byte_offset, sizeof(uint32_t));
+    return l_value;
+}
+
+atl::animation_channel_cursor_type atl::animation_clip_view_type::channel_cursor(uint32_t in_channel) const
+{
+    atl_fatal_assert(internal_valid && in_channel < internal_channel_count, "channel_cursor called on an invalid clip or with an out of range channel");
+    return animation_channel_cursor_type(internal_data + read_u32(animation_clip_header_bytes(in_channel)), internal_data + internal_size, internal_frame_rate);
+}
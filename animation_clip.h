@@ -0,0 +1,190 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "ATLUtil/animation_func.h"
+#include "ATLUtil/bit_string.h"
+#include "ATLUtil/region.h"
+
+namespace atl
+{
+    /*
+     * atl
+     * compressed animation clips
+     *
+     * A clip is a set of float channels, each a keyframe<float> curve. Vector and rotation tracks are split into
+     * one channel per component (see extract_keyframe_channel); sampled quaternions should be renormalized.
+     *
+     * Compression removes keys that linear interpolation can reproduce to within tolerance / 2, snaps key times
+     * to frames at frame_rate, and quantizes values with a step of tolerance, so every sample is within
+     * tolerance of the source curve (at frame-aligned key times). The exception is a channel whose values span
+     * more than 2^24 steps: its step is widened to range / 2^24 to cap values at 25 bits, and its samples are only
+     * within (tolerance + value_step) / 2. encode_animation_channel reports this by returning false.
+     *
+     * Layout, all fields in native byte order (little-endian on x86 and ARM), channels byte aligned:
+     *   clip header:    channel_count (32), frame_rate (32, float bits), channel byte offsets from clip start (32 each)
+     *   channel header: key_count (32), first_frame (32), value_min (32, float bits), value_step (32, float bits),
+     *                   time_bits (8), value_bits (8)
+     *   channel keys:   first value (value_bits), then per key: frame delta (time_bits), value (value_bits)
+     */
+
+    /*
+     extract_keyframe_channel: Copy one float component of each key into a keyframe<float> channel,
+     e.g. extract_keyframe_channel(position_keys, &point3f::y, y_channel).
+     */
+    template <typename KeyframeType>
+    void extract_keyframe_channel(region_type<const keyframe<KeyframeType>> in_keys, float KeyframeType::* in_component, region_type<keyframe<float>> out_channel)
+    {
+        auto l_out = out_channel.begin();
+        for(const auto & l_key : in_keys)
+        {
+            l_out->t = l_key.t;
+            l_out->v = l_key.v.*in_component;
+            ++l_out;
+        }
+    }
+
+    /*
+     reduce_keyframes: Douglas-Peucker key reduction of a single channel. Appends the indices of the keys to keep,
+     in order, always including the first and last. Dropped keys are reproduced to within tolerance by linear
+     interpolation between kept keys.
+     */
+    void reduce_keyframes(region_type<const keyframe<float>> in_keys, float in_tolerance, std::vector<uint32_t> & out_kept_indices);
+
+    struct animation_channel_encoding_type
+    {
+        std::vector<uint32_t> kept_frames;
+        std::vector<uint32_t> kept_values;
+        uint32_t first_frame;
+        float value_min;
+        float value_step;
+        unsigned time_bits;
+        unsigned value_bits;
+        uint32_t size_in_bytes;
+    };
+
+    static const uint32_t animation_channel_header_bytes = 18;
+
+    /*
+     encode_animation_channel: Reduce and quantize a channel, and compute its exact encoded size.
+     Returns false if the value step had to be widened past in_tolerance (see above); the encoding is still usable.
+     */
+    bool encode_animation_channel(region_type<const keyframe<float>> in_keys, float in_frame_rate, float in_tolerance, animation_channel_encoding_type & out_encoding);
+
+    inline size_t animation_clip_header_bytes(uint32_t channel_count)
+    {
+        return 8 + 4 * size_t(channel_count);
+    }
+
+    /*
+     animation_clip_write: Compress channels into output_buffer, which must be byte aligned.
+     Returns false if a channel is empty or the buffer runs out of space. Channels with too wide a value range for
+     the tolerance are written with a wider step rather than failing; call encode_animation_channel to check them.
+     */
+    template <typename output_backing_buffer_type>
+    bool animation_clip_write(bit_string_buffer_wrapper_type<output_backing_buffer_type> & output_buffer,
+                              region_type<const region_type<const keyframe<float>>> in_channels,
+                              float in_frame_rate,
+                              float in_tolerance)
+    {
+        if(output_buffer.bit_offset != 0) return false;
+        const auto l_channel_count = uint32_t(in_channels.size());
+        std::vector<animation_channel_encoding_type> l_encodings(l_channel_count);
+        for(uint32_t i = 0; i < l_channel_count; ++i)
+        {
+            if(in_channels.begin()[i].empty()) return false;
+            encode_animation_channel(in_channels.begin()[i], in_frame_rate, in_tolerance, l_encodings[i]);
+        }
+
+        uint32_t l_frame_rate_bits;
+        std::memcpy(&l_frame_rate_bits, &in_frame_rate, sizeof(float));
+        if(!bit_string_write_bits(output_buffer, l_channel_count, 32)) return false;
+        if(!bit_string_write_bits(output_buffer, l_frame_rate_bits, 32)) return false;
+        auto l_offset = uint32_t(animation_clip_header_bytes(l_channel_count));
+        for(const auto & l_encoding : l_encodings)
+        {
+            if(!bit_string_write_bits(output_buffer, l_offset, 32)) return false;
+            l_offset += l_encoding.size_in_bytes;
+        }
+
+        for(const auto & l_encoding : l_encodings)
+        {
+            uint32_t l_min_bits, l_step_bits;
+            std::memcpy(&l_min_bits, &l_encoding.value_min, sizeof(float));
+            std::memcpy(&l_step_bits, &l_encoding.value_step, sizeof(float));
+            const auto l_key_count = uint32_t(l_encoding.kept_frames.size());
+            if(!bit_string_write_bits(output_buffer, l_key_count, 32)) return false;
+            if(!bit_string_write_bits(output_buffer, l_encoding.first_frame, 32)) return false;
+            if(!bit_string_write_bits(output_buffer, l_min_bits, 32)) return false;
+            if(!bit_string_write_bits(output_buffer, l_step_bits, 32)) return false;
+            if(!bit_string_write_bits(output_buffer, l_encoding.time_bits, 8)) return false;
+            if(!bit_string_write_bits(output_buffer, l_encoding.value_bits, 8)) return false;
+            if(!bit_string_write_bits(output_buffer, l_encoding.kept_values[0], l_encoding.value_bits)) return false;
+            for(uint32_t k = 1; k < l_key_count; ++k)
+            {
+                if(!bit_string_write_bits(output_buffer, l_encoding.kept_frames[k] - l_encoding.kept_frames[k - 1], l_encoding.time_bits)) return false;
+                if(!bit_string_write_bits(output_buffer, l_encoding.kept_values[k], l_encoding.value_bits)) return false;
+            }
+            if(!bit_string_write_align_to_byte(output_buffer)) return false;
+        }
+        return true;
+    }
+
+    /*
+     animation_channel_cursor_type: Streams one channel of a compressed clip, decoding keys only as sample time passes them.
+     Sampling with non-decreasing time is amortized O(1); sampling backwards restarts the stream from the channel's first key.
+     Values are held before the first key and after the last, as with map_keyframe.
+     */
+    struct animation_channel_cursor_type
+    {
+        animation_channel_cursor_type(const bit_string_byte_type * in_channel_begin, const bit_string_byte_type * in_clip_end, float in_frame_rate);
+
+        float sample(float in_t);
+        void restart();
+
+        uint32_t key_count() const { return internal_key_count; }
+
+    private:
+        void read_next_key();
+
+        // simple_backing_buffer_type takes a mutable pointer, but the cursor only ever reads through it.
+        bit_string_byte_type * internal_keys_begin;
+        bit_string_byte_type * internal_clip_end;
+        bit_string_buffer_wrapper_type<simple_backing_buffer_type> internal_stream;
+        float internal_frame_rate;
+        float internal_value_min;
+        float internal_value_step;
+        unsigned internal_time_bits;
+        unsigned internal_value_bits;
+        uint32_t internal_key_count;
+        uint32_t internal_first_frame;
+        uint32_t internal_keys_read;
+        uint32_t internal_prev_frame, internal_next_frame;
+        float internal_prev_value, internal_next_value;
+    };
+
+    /*
+     animation_clip_view_type: Reads the header of a compressed clip in place, and hands out channel cursors.
+     */
+    struct animation_clip_view_type
+    {
+        animation_clip_view_type(const bit_string_byte_type * in_data, size_t in_size);
+
+        bool valid() const { return internal_valid; }
+        uint32_t channel_count() const { return internal_channel_count; }
+        float frame_rate() const { return internal_frame_rate; }
+        // The view must be valid() and in_channel less than channel_count().
+        animation_channel_cursor_type channel_cursor(uint32_t in_channel) const;
+
+    private:
+        uint32_t read_u32(size_t in_byte_offset) const;
+
+        const bit_string_byte_type * internal_data;
+        size_t internal_size;
+        uint32_t internal_channel_count;
+        float internal_frame_rate;
+        bool internal_valid;
+    };
+}
@@ -45,3 +45,68 @@ atl::point2f atl::shake(const float in_magnitude, const float in_phase)
 	auto y_amount = in_magnitude * sine_val;
     return atl::point2f(sine_val * x_amount, cos_val * y_amount);
 }
+
+void atl::ease_in_style1(region_type<const float> in_values, region_type<float> out_values, const float in_bounce)
+{
+    const auto l_count = in_values.size();
+    const float * l_in = in_values.begin();
+    float * l_out = out_values.begin();
+    for(std::ptrdiff_t i = 0; i < l_count; ++i)
+    {
+        const float l_squared = l_in[i] * l_in[i];
+        l_out[i] = l_squared + atl::fast_sinf(l_squared * atl::numbers::pi_f) * in_bounce;
+    }
+}
+
+void atl::ease_in_style2(region_type<const float> in_values, region_type<float> out_values)
+{
+    const auto l_count = in_values.size();
+    const float * l_in = in_values.begin();
+    float * l_out = out_values.begin();
+    for(std::ptrdiff_t i = 0; i < l_count; ++i)
+    {
+        const float l_cos = atl::fast_cosf(l_in[i] * atl::numbers::half_pi_f);
+        const float l_cos_squared = l_cos * l_cos;
+        l_out[i] = 1.f - l_cos_squared * l_cos_squared;
+    }
+}
+
+void atl::ease_in_sine(region_type<const float> in_values, region_type<float> out_values)
+{
+    const auto l_count = in_values.size();
+    const float * l_in = in_values.begin();
+    float * l_out = out_values.begin();
+    for(std::ptrdiff_t i = 0; i < l_count; ++i)
+        l_out[i] = 1.f - atl::fast_cosf(l_in[i] * atl::numbers::half_pi_f);
+}
+
+void atl::ease_out_sine(region_type<const float> in_values, region_type<float> out_values)
+{
+    const auto l_count = in_values.size();
+    const float * l_in = in_values.begin();
+    float * l_out = out_values.begin();
+    for(std::ptrdiff_t i = 0; i < l_count; ++i)
+        l_out[i] = atl::fast_cosf((1.f - l_in[i]) * atl::numbers::half_pi_f);
+}
+
+void atl::ease_in_out_sine(region_type<const float> in_values, region_type<float> out_values)
+{
+    const auto l_count = in_values.size();
+    const float * l_in = in_values.begin();
+    float * l_out = out_values.begin();
+    for(std::ptrdiff_t i = 0; i < l_count; ++i)
+        l_out[i] = (atl::fast_cosf((1.f + l_in[i]) * atl::numbers::pi_f) + 1.f) * 0.5f;
+}
+
+void atl::ease_in_style2_integral(region_type<const float> in_values, region_type<float> out_values)
+{
+    const auto l_count = in_values.size();
+    const float * l_in = in_values.begin();
+    float * l_out = out_values.begin();
+    for(std::ptrdiff_t i = 0; i < l_count; ++i)
+    {
+        const float l_sin = atl::fast_sinf(atl::numbers::pi_f * l_in[i]);
+        const float l_cos = atl::fast_cosf(atl::numbers::pi_f * l_in[i]);
+        l_out[i] = (5.f * l_in[i]) / 8.f - l_sin / atl::numbers::two_pi_f - (l_sin * l_cos) / atl::numbers::eight_pi_f;
+    }
+}
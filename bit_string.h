@@ -5,8 +5,15 @@
 #include <type_traits>
 #include <limits>
 #include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
 
 #include "ATLUtil/numeric_casts.h"
+#include "ATLUtil/region.h"
 
 namespace atl
 {
@@ -176,7 +183,7 @@ namespace atl
      * atl
      * bit string definition
      */
-#pragma message("TODO: Move the backing buffer stuff out into its own file, make utility functions for auto wrapping regions, make a region that auto reallocs with geometric growth, plus a utility function to get the atl::region from a backing buffer, IE {begin,ptr}")
+#pragma message("TODO: Move the backing buffer stuff out into its own file, make utility functions for auto wrapping regions")
     using bit_string_byte_type = unsigned char;
 
     struct backing_buffer_reserve_bytes_result_type
@@ -206,10 +213,91 @@ namespace atl
         return bit_string_buffer_wrapper_type<backing_buffer_type>(backing_buffer, in_bit_offset);
     }
 
+    /*
+     * atl
+     * word-at-a-time bit copying
+     *
+     * Bits are stored least significant first in each byte, so a run of bytes read as a little-endian word keeps
+     * its bits in stream order and a misaligned run can be moved with one shift per 64 bits. Big-endian targets
+     * assemble the words a byte at a time instead.
+     */
+    inline uint64_t bit_string_load_word(const bit_string_byte_type* bytes)
+    {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        uint64_t word = 0;
+        for(unsigned i = 0; i < 8; ++i)
+            word |= uint64_t{bytes[i]} << (i * 8);
+        return word;
+#else
+        uint64_t word;
+        std::memcpy(&word, bytes, sizeof(word));
+        return word;
+#endif
+    }
+
+    inline void bit_string_store_word(bit_string_byte_type* bytes, uint64_t word)
+    {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        for(unsigned i = 0; i < 8; ++i)
+            bytes[i] = bit_string_byte_type(word >> (i * 8));
+#else
+        std::memcpy(bytes, &word, sizeof(word));
+#endif
+    }
+
+    // Index of the lowest / highest set bit of a non-zero word.
+    inline unsigned bit_string_lowest_set_bit(uint64_t word)
+    {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward64(&index, word);
+        return unsigned(index);
+#elif defined(__GNUC__)
+        return unsigned(__builtin_ctzll(word));
+#else
+        unsigned index = 0;
+        while((word & 1) == 0) { word >>= 1; ++index; }
+        return index;
+#endif
+    }
+
+    inline unsigned bit_string_highest_set_bit(uint64_t word)
+    {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanReverse64(&index, word);
+        return unsigned(index);
+#elif defined(__GNUC__)
+        return 63u - unsigned(__builtin_clzll(word));
+#else
+        unsigned index = 0;
+        while(word >>= 1) ++index;
+        return index;
+#endif
+    }
+
+    // Whole output bytes from a stream that is shift (1 to 7) bits into first_byte, with input continuing at in:
+    // out[0] takes the top bits of first_byte and the bottom of in[0], out[j] those of in[j - 1] and in[j].
+    inline void bit_string_shift_bytes(bit_string_byte_type first_byte, const bit_string_byte_type* in, bit_string_byte_type* out, size_t count, unsigned shift)
+    {
+        out[0] = bit_string_byte_type((first_byte >> shift) | (in[0] << (8 - shift)));
+        size_t j = 1;
+        for(; j + 8 <= count; j += 8)
+            bit_string_store_word(out + j, (bit_string_load_word(in + j - 1) >> shift) | (uint64_t{in[j + 7]} << (64 - shift)));
+        for(; j < count; ++j)
+            out[j] = bit_string_byte_type((in[j - 1] >> shift) | (in[j] << (8 - shift)));
+    }
+
     /* 
      * atl
      * bit string functions
      */    
+
+    /*
+     bit_string_copy_bits: Once the output is on a byte boundary, whole bytes are copied in blocks as large as both
+     backing buffers allow: by memcpy when the input is byte aligned too, by 64-bit shifts when it is not. Only the
+     few bits needed to align the output, and the tail, go through bitwise_copy_apply. Input and output must not overlap.
+     */
     template <typename input_backing_buffer_type, typename output_backing_buffer_type>
     bool bit_string_copy_bits(bit_string_buffer_wrapper_type<input_backing_buffer_type>& input_buffer, bit_string_buffer_wrapper_type<output_backing_buffer_type>& output_buffer, const unsigned total_bits_to_copy)
     {
@@ -218,15 +306,22 @@ namespace atl
         {
             const auto remaining_bits = total_bits_to_copy - total_bits_copied;
             const auto remaining_bytes = remaining_bits / 8;
-            // Write byte-aligned data of largest possible size:
-            if(remaining_bytes > 0 && input_buffer.bit_offset == 0 && output_buffer.bit_offset == 0)
+            // Write whole output bytes in blocks of largest possible size:
+            if(remaining_bytes > 0 && output_buffer.bit_offset == 0 && (input_buffer.bit_offset == 0 || input_buffer.current_byte != nullptr))
             {
                 const auto available_input_bytes = input_buffer.backing_buffer.reserve_bytes(remaining_bytes);
                 const auto available_output_bytes = output_buffer.backing_buffer.reserve_bytes(available_input_bytes.size);
                 const auto copyable_bytes = available_output_bytes.size;
                 if(copyable_bytes > 0)
                 {
-                    std::copy(available_input_bytes.ptr, available_input_bytes.ptr + copyable_bytes, available_output_bytes.ptr);
+                    if(input_buffer.bit_offset == 0)
+                        std::memcpy(available_output_bytes.ptr, available_input_bytes.ptr, copyable_bytes);
+                    else
+                    {
+                        // Each output byte finishes one input byte and starts the next, which becomes the partial input byte.
+                        bit_string_shift_bytes(*input_buffer.current_byte, available_input_bytes.ptr, available_output_bytes.ptr, copyable_bytes, input_buffer.bit_offset);
+                        input_buffer.current_byte = available_input_bytes.ptr + copyable_bytes - 1;
+                    }
                     total_bits_copied += copyable_bytes * 8;
                     input_buffer.backing_buffer.advance(copyable_bytes);
                     output_buffer.backing_buffer.advance(copyable_bytes);
@@ -243,7 +338,7 @@ namespace atl
             if(output_buffer.bit_offset == 0)
             {
                 output_byte = output_buffer.backing_buffer.reserve_bytes(1).ptr;
-                *output_byte = 0;
+                if(output_byte != nullptr) *output_byte = 0;
             }
             else output_byte = output_buffer.current_byte;
             if(output_byte == nullptr) return false;
@@ -302,6 +397,8 @@ namespace atl
             auto available_bytes = most_available(num_bytes);
             return {available_bytes > 0 ? ptr : nullptr, available_bytes};
         }
+        // The bytes advanced over so far, IE {begin, ptr}. A partially written last byte is included.
+        region_type<bit_string_byte_type> written() const { return {begin, ptr}; }
     };
 
     inline simple_backing_buffer_type simple_backing_buffer(bit_string_byte_type* in_begin, size_t in_size)
@@ -309,6 +406,44 @@ namespace atl
         return simple_backing_buffer_type(in_begin, in_size);
     }
 
+    /*
+     growable_backing_buffer_type: A write buffer that never runs out. It writes into a caller-owned byte vector
+     from the start, growing it geometrically (at least doubling, and by no less than minimum_growth bytes) when a
+     reservation does not fit. The vector's size is the capacity in use, so keeping one vector and wrapping it
+     again each frame reuses its storage without reallocating once it has grown to the largest frame.
+
+     Growth moves the bytes, which is safe for writers: bit_string_copy_bits only reserves output on a byte
+     boundary, when no pointer into the partial byte is kept. To read the result back, wrap written() in a
+     simple_backing_buffer.
+     */
+    struct growable_backing_buffer_type
+    {
+        static constexpr size_t minimum_growth = 4096;
+
+        std::vector<bit_string_byte_type>* storage;
+        size_t write_offset;
+
+        explicit growable_backing_buffer_type(std::vector<bit_string_byte_type>& in_storage)
+            :
+            storage(&in_storage),
+            write_offset(0)
+        {}
+        void advance(unsigned num_bytes) { write_offset = std::min(write_offset + num_bytes, storage->size()); }
+        backing_buffer_reserve_bytes_result_type reserve_bytes(unsigned num_bytes)
+        {
+            const size_t required_size = write_offset + num_bytes;
+            if(required_size > storage->size())
+                storage->resize(std::max(required_size, storage->size() + std::max(storage->size(), minimum_growth)));
+            return {num_bytes > 0 ? storage->data() + write_offset : nullptr, num_bytes};
+        }
+        region_type<bit_string_byte_type> written() const { return region_n(storage->data(), write_offset); }
+    };
+
+    inline growable_backing_buffer_type growable_backing_buffer(std::vector<bit_string_byte_type>& in_storage)
+    {
+        return growable_backing_buffer_type(in_storage);
+    }
+
     template <typename value_type>
     bit_string_buffer_wrapper_type<simple_backing_buffer_type> value_backing_buffer(value_type& value)
     {
@@ -321,9 +456,14 @@ namespace atl
         if constexpr(std::is_same<value_type, bool>::value)
         {
             const unsigned char copy_byte = (bool)input_value ? (const unsigned char)0xFF : (const unsigned char)0x00;
-            return bit_string_copy_bits(value_backing_buffer(copy_byte), output_buffer, 1);
+            auto input_buffer = value_backing_buffer(copy_byte);
+            return bit_string_copy_bits(input_buffer, output_buffer, 1);
+        }
+        else
+        {
+            auto input_buffer = value_backing_buffer(input_value);
+            return bit_string_copy_bytes(input_buffer, output_buffer, sizeof(value_type));
         }
-        else return bit_string_copy_bytes(value_backing_buffer(input_value), output_buffer, sizeof(value_type));
     }
 
     template <typename input_backing_buffer_type, typename value_type>
@@ -331,12 +471,51 @@ namespace atl
     {
         if constexpr(std::is_same<value_type, bool>::value)
         {
-            unsigned char output_byte;
-            if(!bit_string_copy_bits(input_buffer, value_backing_buffer(output_byte), 1)) return false;
+            unsigned char output_byte = 0;
+            auto output_buffer = value_backing_buffer(output_byte);
+            if(!bit_string_copy_bits(input_buffer, output_buffer, 1)) return false;
             output_value = output_byte != 0;
             return true;
         }
-        else return bit_string_copy_bytes(input_buffer, value_backing_buffer(output_value), sizeof(value_type));
+        else
+        {
+            auto output_buffer = value_backing_buffer(output_value);
+            return bit_string_copy_bytes(input_buffer, output_buffer, sizeof(value_type));
+        }
+    }
+
+    // Write the low bit_count bits of an unsigned integer.
+    template <typename integer_type, typename output_backing_buffer_type>
+    bool bit_string_write_bits(bit_string_buffer_wrapper_type<output_backing_buffer_type>& output_buffer, integer_type value, unsigned bit_count)
+    {
+        static_assert(std::is_unsigned<integer_type>::value, "bit_string_write_bits: use an unsigned type");
+        auto input_buffer = value_backing_buffer(value);
+        return bit_string_copy_bits(input_buffer, output_buffer, bit_count);
+    }
+
+    // Read bit_count bits into the low bits of an unsigned integer, zeroing the rest.
+    template <typename integer_type, typename input_backing_buffer_type>
+    bool bit_string_read_bits(bit_string_buffer_wrapper_type<input_backing_buffer_type>& input_buffer, integer_type& value, unsigned bit_count)
+    {
+        static_assert(std::is_unsigned<integer_type>::value, "bit_string_read_bits: use an unsigned type");
+        value = 0;
+        auto output_buffer = value_backing_buffer(value);
+        return bit_string_copy_bits(input_buffer, output_buffer, bit_count);
+    }
+
+    // Pad with zero bits up to the next byte boundary.
+    template <typename output_backing_buffer_type>
+    bool bit_string_write_align_to_byte(bit_string_buffer_wrapper_type<output_backing_buffer_type>& output_buffer)
+    {
+        return bit_string_write_bits(output_buffer, unsigned{0}, (8 - output_buffer.bit_offset) % 8);
+    }
+
+    // Skip bits up to the next byte boundary.
+    template <typename input_backing_buffer_type>
+    bool bit_string_read_align_to_byte(bit_string_buffer_wrapper_type<input_backing_buffer_type>& input_buffer)
+    {
+        unsigned padding;
+        return bit_string_read_bits(input_buffer, padding, (8 - input_buffer.bit_offset) % 8);
     }
     
     template <typename integer_type, typename output_backing_buffer_type>
@@ -344,8 +523,9 @@ namespace atl
     {
         if(max == min) return true;
         else if(min > max) return false;
-        value -= min;
-        return bit_string_copy_bits(value_backing_buffer(value), output_buffer, bits_required_for_integer(max - min));
+        integer_type delta = value - min;
+        auto input_buffer = value_backing_buffer(delta);
+        return bit_string_copy_bits(input_buffer, output_buffer, bits_required_for_integer(max - min));
     }
 
     template <typename integer_type, typename input_backing_buffer_type>
@@ -358,7 +538,8 @@ namespace atl
         }
         else if(min > max) return false;
         auto delta = integer_type{0};
-        if(bit_string_copy_bits(input_buffer, value_backing_buffer(delta), bits_required_for_integer(max - min)))
+        auto output_buffer = value_backing_buffer(delta);
+        if(bit_string_copy_bits(input_buffer, output_buffer, bits_required_for_integer(max - min)))
         {
             value = min + delta;
             return true;
@@ -366,6 +547,196 @@ namespace atl
         else return false;
     }
     
+    /*
+     * atl
+     * bulk arrays
+     *
+     * Arrays are packed at a fixed bit width into a stack staging block, which is then copied to the output with a
+     * single bit_string_copy_bits call per block (so per block, not per value, the output may be misaligned).
+     * Reads copy a block into staging and unpack each value with one unaligned 64-bit load, shift and mask.
+     * The stream layout is the same as writing the values one at a time with bit_string_write_bits.
+     */
+    static constexpr unsigned bit_string_staging_bytes = 512;
+
+    // Packs count values of bit_count (1 to 64) bits, least significant first. out must hold (count * bit_count + 7) / 8 bytes.
+    template <typename value_function_type>
+    void bit_string_pack_values(bit_string_byte_type* out, size_t count, unsigned bit_count, const value_function_type& value_function)
+    {
+        const unsigned low_bits = std::min(bit_count, 32u);
+        const unsigned high_bits = bit_count - low_bits;
+        const uint64_t low_mask = (uint64_t{1} << low_bits) - 1;
+        const uint64_t high_mask = (uint64_t{1} << high_bits) - 1;
+        uint64_t accumulator = 0;
+        unsigned accumulated_bits = 0;
+        auto push = [&](uint64_t bits, unsigned width)
+        {
+            accumulator |= bits << accumulated_bits;
+            accumulated_bits += width;
+            if(accumulated_bits >= 32)
+            {
+                for(unsigned i = 0; i < 4; ++i)
+                    *out++ = bit_string_byte_type(accumulator >> (i * 8));
+                accumulator >>= 32;
+                accumulated_bits -= 32;
+            }
+        };
+        for(size_t i = 0; i < count; ++i)
+        {
+            const uint64_t value = value_function(i);
+            push(value & low_mask, low_bits);
+            if(high_bits > 0)
+                push((value >> 32) & high_mask, high_bits);
+        }
+        for(unsigned i = 0; i < accumulated_bits; i += 8)
+            *out++ = bit_string_byte_type(accumulator >> i);
+    }
+
+    // Unpacks count values of bit_count (1 to 64) bits. in must be readable for 8 bytes past the packed data.
+    template <typename store_function_type>
+    void bit_string_unpack_values(const bit_string_byte_type* in, size_t count, unsigned bit_count, const store_function_type& store_function)
+    {
+        const unsigned low_bits = std::min(bit_count, 32u);
+        const unsigned high_bits = bit_count - low_bits;
+        const uint64_t low_mask = (uint64_t{1} << low_bits) - 1;
+        const uint64_t high_mask = (uint64_t{1} << high_bits) - 1;
+        size_t bit_position = 0;
+        for(size_t i = 0; i < count; ++i)
+        {
+            uint64_t value = (bit_string_load_word(in + bit_position / 8) >> (bit_position % 8)) & low_mask;
+            if(high_bits > 0)
+            {
+                const size_t high_position = bit_position + 32;
+                value |= ((bit_string_load_word(in + high_position / 8) >> (high_position % 8)) & high_mask) << 32;
+            }
+            store_function(i, value);
+            bit_position += bit_count;
+        }
+    }
+
+    // Values per staging block: a multiple of 8, so that every block but the last ends on a byte boundary.
+    constexpr size_t bit_string_staging_values(unsigned bit_count)
+    {
+        return (bit_string_staging_bytes * 8 / bit_count) & ~size_t{7};
+    }
+
+    template <typename value_function_type, typename output_backing_buffer_type>
+    bool bit_string_write_packed_values(bit_string_buffer_wrapper_type<output_backing_buffer_type>& output_buffer, size_t count, unsigned bit_count, const value_function_type& value_function)
+    {
+        if(bit_count == 0) return true;
+        if(bit_count > 64) return false;
+        bit_string_byte_type staging[bit_string_staging_bytes];
+        const size_t block_values = bit_string_staging_values(bit_count);
+        for(size_t first = 0; first < count; first += block_values)
+        {
+            const size_t values = std::min(block_values, count - first);
+            bit_string_pack_values(staging, values, bit_count, [&](size_t i) { return value_function(first + i); });
+            auto staging_buffer = bit_string_wrap_backing_buffer(simple_backing_buffer(staging, sizeof(staging)));
+            if(!bit_string_copy_bits(staging_buffer, output_buffer, unsigned(values * bit_count))) return false;
+        }
+        return true;
+    }
+
+    template <typename store_function_type, typename input_backing_buffer_type>
+    bool bit_string_read_packed_values(bit_string_buffer_wrapper_type<input_backing_buffer_type>& input_buffer, size_t count, unsigned bit_count, const store_function_type& store_function)
+    {
+        if(bit_count > 64) return false;
+        if(bit_count == 0)
+        {
+            for(size_t i = 0; i < count; ++i)
+                store_function(i, uint64_t{0});
+            return true;
+        }
+        // The padding keeps the 64-bit loads of the last values inside the array.
+        bit_string_byte_type staging[bit_string_staging_bytes + 8] = {};
+        const size_t block_values = bit_string_staging_values(bit_count);
+        for(size_t first = 0; first < count; first += block_values)
+        {
+            const size_t values = std::min(block_values, count - first);
+            auto staging_buffer = bit_string_wrap_backing_buffer(simple_backing_buffer(staging, bit_string_staging_bytes));
+            if(!bit_string_copy_bits(input_buffer, staging_buffer, unsigned(values * bit_count))) return false;
+            bit_string_unpack_values(staging, values, bit_count, [&](size_t i, uint64_t value) { store_function(first + i, value); });
+        }
+        return true;
+    }
+
+    /*
+     bit_string_write_packed: The low bit_count bits of each value, IE bit_string_write_bits over the array.
+     When bit_count is the full width of the type, the array's bytes are copied directly.
+     */
+    template <typename integer_type, typename output_backing_buffer_type>
+    bool bit_string_write_packed(bit_string_buffer_wrapper_type<output_backing_buffer_type>& output_buffer, region_type<const integer_type> values, unsigned bit_count)
+    {
+        static_assert(std::is_unsigned<integer_type>::value, "bit_string_write_packed: use an unsigned type");
+#if !defined(__BYTE_ORDER__) || __BYTE_ORDER__ != __ORDER_BIG_ENDIAN__
+        if(bit_count == sizeof(integer_type) * 8)
+        {
+            auto input_buffer = bit_string_wrap_backing_buffer(simple_backing_buffer((bit_string_byte_type*)values.begin(), size_t(values.size()) * sizeof(integer_type)));
+            return bit_string_copy_bits(input_buffer, output_buffer, unsigned(values.size() * bit_count));
+        }
+#endif
+        const integer_type* in = values.begin();
+        return bit_string_write_packed_values(output_buffer, size_t(values.size()), bit_count, [in](size_t i) { return uint64_t{in[i]}; });
+    }
+
+    template <typename integer_type, typename input_backing_buffer_type>
+    bool bit_string_read_packed(bit_string_buffer_wrapper_type<input_backing_buffer_type>& input_buffer, region_type<integer_type> values, unsigned bit_count)
+    {
+        static_assert(std::is_unsigned<integer_type>::value, "bit_string_read_packed: use an unsigned type");
+#if !defined(__BYTE_ORDER__) || __BYTE_ORDER__ != __ORDER_BIG_ENDIAN__
+        if(bit_count == sizeof(integer_type) * 8)
+        {
+            auto output_buffer = bit_string_wrap_backing_buffer(simple_backing_buffer((bit_string_byte_type*)values.begin(), size_t(values.size()) * sizeof(integer_type)));
+            return bit_string_copy_bits(input_buffer, output_buffer, unsigned(values.size() * bit_count));
+        }
+#endif
+        integer_type* out = values.begin();
+        return bit_string_read_packed_values(input_buffer, size_t(values.size()), bit_count, [out](size_t i, uint64_t value) { out[i] = integer_type(value); });
+    }
+
+    /*
+     bit_string_write_ranged_integers: bit_string_write_ranged_integer over an array, with the width computed once.
+     */
+    template <typename integer_type, typename output_backing_buffer_type>
+    bool bit_string_write_ranged_integers(bit_string_buffer_wrapper_type<output_backing_buffer_type>& output_buffer, region_type<const integer_type> values, const integer_type min, const integer_type max)
+    {
+        using unsigned_type = typename std::make_unsigned<integer_type>::type;
+        if(max == min) return true;
+        else if(min > max) return false;
+        const unsigned bit_count = unsigned(bits_required_for_integer(unsigned_type(unsigned_type(max) - unsigned_type(min))));
+        const integer_type* in = values.begin();
+        return bit_string_write_packed_values(output_buffer, size_t(values.size()), bit_count, [in, min](size_t i) { return uint64_t{unsigned_type(unsigned_type(in[i]) - unsigned_type(min))}; });
+    }
+
+    template <typename integer_type, typename input_backing_buffer_type>
+    bool bit_string_read_ranged_integers(bit_string_buffer_wrapper_type<input_backing_buffer_type>& input_buffer, region_type<integer_type> values, const integer_type min, const integer_type max)
+    {
+        using unsigned_type = typename std::make_unsigned<integer_type>::type;
+        if(min > max) return false;
+        const unsigned bit_count = unsigned(bits_required_for_integer(unsigned_type(unsigned_type(max) - unsigned_type(min))));
+        integer_type* out = values.begin();
+        return bit_string_read_packed_values(input_buffer, size_t(values.size()), bit_count, [out, min](size_t i, uint64_t value) { out[i] = integer_type(unsigned_type(min) + unsigned_type(value)); });
+    }
+
+    /*
+     bit_string_write_values: The raw bytes of each value, IE bit_string_write_value over an array of floats or
+     other plain types (not bool), as one copy.
+     */
+    template <typename value_type, typename output_backing_buffer_type>
+    bool bit_string_write_values(bit_string_buffer_wrapper_type<output_backing_buffer_type>& output_buffer, region_type<const value_type> values)
+    {
+        static_assert(!std::is_same<value_type, bool>::value, "bit_string_write_values: pack bools with bit_string_write_packed");
+        auto input_buffer = bit_string_wrap_backing_buffer(simple_backing_buffer((bit_string_byte_type*)values.begin(), size_t(values.size()) * sizeof(value_type)));
+        return bit_string_copy_bits(input_buffer, output_buffer, unsigned(values.size() * sizeof(value_type) * 8));
+    }
+
+    template <typename value_type, typename input_backing_buffer_type>
+    bool bit_string_read_values(bit_string_buffer_wrapper_type<input_backing_buffer_type>& input_buffer, region_type<value_type> values)
+    {
+        static_assert(!std::is_same<value_type, bool>::value, "bit_string_read_values: unpack bools with bit_string_read_packed");
+        auto output_buffer = bit_string_wrap_backing_buffer(simple_backing_buffer((bit_string_byte_type*)values.begin(), size_t(values.size()) * sizeof(value_type)));
+        return bit_string_copy_bits(input_buffer, output_buffer, unsigned(values.size() * sizeof(value_type) * 8));
+    }
+    
     template <typename integer_type, typename output_backing_buffer_type>
     bool bit_string_write_chunked_integer(bit_string_buffer_wrapper_type<output_backing_buffer_type>& output_buffer, integer_type value, unsigned chunk_size)
     {
@@ -377,7 +748,8 @@ namespace atl
         {
             local_integer_type write_val = current_value & mask;
             if(!bit_string_write_value(output_buffer, true)) return false;
-            if(!bit_string_copy_bits(value_backing_buffer(write_val), output_buffer, chunk_size)) return false;
+            auto input_buffer = value_backing_buffer(write_val);
+            if(!bit_string_copy_bits(input_buffer, output_buffer, chunk_size)) return false;
             current_value = current_value >> chunk_size;
         }
         if(!bit_string_write_value(output_buffer, false)) return false;
@@ -395,7 +767,8 @@ namespace atl
         while(chunk_flag)
         {
             chunk = 0;
-            if(!bit_string_copy_bits(input_buffer, value_backing_buffer(chunk), chunk_size)) return false;
+            auto output_buffer = value_backing_buffer(chunk);
+            if(!bit_string_copy_bits(input_buffer, output_buffer, chunk_size)) return false;
             result += chunk << current_bit;
             current_bit += chunk_size;
             chunk_flag = 0;
@@ -414,6 +787,313 @@ namespace atl
         return true;
     }
 
+    /*
+     * atl
+     * variable length codes
+     *
+     * Codes for integers that are usually small, such as entity ids and deltas. Signed values are zigzag mapped first
+     * (0, -1, 1, -2 ... to 0, 1, 2, 3 ...), as bit_string_write_chunked_integer does, so small magnitudes stay short.
+     * - varint: LEB128, 7 bits per byte, least significant group first, with the top bit set on every byte but the
+     *   last. Byte granular, and cheapest where the stream is byte aligned, but it does not need to be.
+     * - Elias gamma: value + 1 = 2^n + r is n zero bits, a one, then r in n bits; 2n + 1 bits in all.
+     * - Elias delta: n in gamma, then r in n bits. One bit longer than gamma for values 7 to 14, shorter from 31 on.
+     * - Rice: with parameter k, value >> k as that many zero bits and a one, then the low k bits. Best when values
+     *   are roughly geometric with a mean around 2^k. The quotient value >> k may be at most
+     *   bit_string_rice_max_quotient: writing a larger one returns false with nothing written, and reading one fails.
+     *   A value that far out means k is too small for the data; gamma and delta codes have no such limit.
+     * Encoders assemble each code and write it with one bit copy (two for very long codes). Decoders peek at the
+     * next 64 bits and find code lengths with a bit scan (and, for varints, a mask over the continuation bits),
+     * instead of reading a bit or a byte at a time.
+     */
+    template <typename integer_type>
+    constexpr typename std::make_unsigned<integer_type>::type zigzag_encode(integer_type value)
+    {
+        using unsigned_type = typename std::make_unsigned<integer_type>::type;
+        return unsigned_type(unsigned_type(unsigned_type(value) << 1) ^ unsigned_type(value >> (sizeof(integer_type) * 8 - 1)));
+    }
+
+    template <typename integer_type>
+    constexpr integer_type zigzag_decode(typename std::make_unsigned<integer_type>::type value)
+    {
+        using unsigned_type = typename std::make_unsigned<integer_type>::type;
+        return integer_type(unsigned_type((value >> 1) ^ unsigned_type(unsigned_type{0} - (value & 1))));
+    }
+
+    static_assert(zigzag_encode<int>(0) == 0u && zigzag_encode<int>(-1) == 1u && zigzag_encode<int>(1) == 2u && zigzag_encode<int>(-2) == 3u, "zigzag_encode: small values");
+    static_assert(zigzag_encode<int8_t>(-128) == 255u && zigzag_encode<int8_t>(127) == 254u, "zigzag_encode: int8_t extremes");
+    static_assert(zigzag_decode<int>(3u) == -2 && zigzag_decode<int>(4u) == 2, "zigzag_decode: small values");
+    static_assert(zigzag_decode<int64_t>(~uint64_t{0}) == std::numeric_limits<int64_t>::min(), "zigzag_decode: int64_t min");
+
+    // The unsigned code for a value: zigzag for signed types, the value itself otherwise.
+    template <typename integer_type>
+    constexpr uint64_t bit_string_code_from_integer(integer_type value)
+    {
+        static_assert(std::is_integral<integer_type>::value && sizeof(integer_type) <= 8, "bit_string variable length codes: use an integer of up to 64 bits");
+        if constexpr(std::is_signed<integer_type>::value) return zigzag_encode(value);
+        else return value;
+    }
+
+    template <typename integer_type>
+    constexpr integer_type bit_string_integer_from_code(uint64_t code)
+    {
+        using unsigned_type = typename std::make_unsigned<integer_type>::type;
+        if constexpr(std::is_signed<integer_type>::value) return zigzag_decode<integer_type>(unsigned_type(code));
+        else return integer_type(code);
+    }
+
+    // Low bit_count bits set, for bit_count up to 64.
+    constexpr uint64_t bit_string_low_mask(unsigned bit_count)
+    {
+        return bit_count >= 64 ? ~uint64_t{0} : (uint64_t{1} << bit_count) - 1;
+    }
+
+    /*
+     bit_string_peek_bits: The next bits of the stream without consuming them, first bit lowest. Returns how many
+     are valid: 64 when the input is byte aligned, at least 57 otherwise, fewer only near the end. Bits past that
+     are zero.
+     */
+    template <typename input_backing_buffer_type>
+    unsigned bit_string_peek_bits(bit_string_buffer_wrapper_type<input_backing_buffer_type>& input_buffer, uint64_t& bits)
+    {
+        const unsigned partial_bits = input_buffer.bit_offset == 0 ? 0 : 8 - input_buffer.bit_offset;
+        const auto bytes = input_buffer.backing_buffer.reserve_bytes(8);
+        uint64_t word = 0;
+        if(bytes.size >= 8)
+            word = bit_string_load_word(bytes.ptr);
+        else
+        {
+            for(unsigned i = 0; i < bytes.size; ++i)
+                word |= uint64_t{bytes.ptr[i]} << (i * 8);
+        }
+        if(partial_bits > 0)
+            word = (word << partial_bits) | (*input_buffer.current_byte >> input_buffer.bit_offset);
+        bits = word;
+        return std::min(partial_bits + bytes.size * 8, 64u);
+    }
+
+    // Consume bit_count bits, which must have been peeked.
+    template <typename input_backing_buffer_type>
+    bool bit_string_skip_bits(bit_string_buffer_wrapper_type<input_backing_buffer_type>& input_buffer, unsigned bit_count)
+    {
+        const unsigned partial_bits = input_buffer.bit_offset == 0 ? 0 : 8 - input_buffer.bit_offset;
+        if(bit_count < partial_bits)
+        {
+            input_buffer.bit_offset += bit_count;
+            return true;
+        }
+        bit_count -= partial_bits;
+        input_buffer.bit_offset = 0;
+        const unsigned whole_bytes = bit_count / 8;
+        if(whole_bytes > 0)
+        {
+            if(input_buffer.backing_buffer.reserve_bytes(whole_bytes).size < whole_bytes) return false;
+            input_buffer.backing_buffer.advance(whole_bytes);
+        }
+        if(bit_count % 8 != 0)
+        {
+            bit_string_byte_type* byte = input_buffer.backing_buffer.reserve_bytes(1).ptr;
+            if(byte == nullptr) return false;
+            input_buffer.backing_buffer.advance(1);
+            input_buffer.current_byte = byte;
+            input_buffer.bit_offset = bit_count % 8;
+        }
+        return true;
+    }
+
+    // count zero bits, then a one.
+    template <typename output_backing_buffer_type>
+    bool bit_string_write_unary(bit_string_buffer_wrapper_type<output_backing_buffer_type>& output_buffer, uint64_t count)
+    {
+        for(; count >= 64; count -= 64)
+            if(!bit_string_write_bits(output_buffer, uint64_t{0}, 64)) return false;
+        return bit_string_write_bits(output_buffer, uint64_t{1} << count, unsigned(count) + 1);
+    }
+
+    template <typename input_backing_buffer_type>
+    bool bit_string_read_unary(bit_string_buffer_wrapper_type<input_backing_buffer_type>& input_buffer, uint64_t& count)
+    {
+        count = 0;
+        for(;;)
+        {
+            uint64_t bits;
+            const unsigned available = bit_string_peek_bits(input_buffer, bits);
+            if(available == 0) return false;
+            if(bits != 0)
+            {
+                const unsigned zeros = bit_string_lowest_set_bit(bits);
+                count += zeros;
+                return bit_string_skip_bits(input_buffer, zeros + 1);
+            }
+            count += available;
+            if(!bit_string_skip_bits(input_buffer, available)) return false;
+        }
+    }
+
+    template <typename integer_type, typename output_backing_buffer_type>
+    bool bit_string_write_varint(bit_string_buffer_wrapper_type<output_backing_buffer_type>& output_buffer, integer_type value)
+    {
+        uint64_t code = bit_string_code_from_integer(value);
+        bit_string_byte_type bytes[10];
+        unsigned byte_count = 0;
+        while(code >= 0x80)
+        {
+            bytes[byte_count++] = bit_string_byte_type(code | 0x80);
+            code >>= 7;
+        }
+        bytes[byte_count++] = bit_string_byte_type(code);
+        auto input_buffer = bit_string_wrap_backing_buffer(simple_backing_buffer(bytes, byte_count));
+        return bit_string_copy_bits(input_buffer, output_buffer, byte_count * 8);
+    }
+
+    template <typename integer_type, typename input_backing_buffer_type>
+    bool bit_string_read_varint(bit_string_buffer_wrapper_type<input_backing_buffer_type>& input_buffer, integer_type& value)
+    {
+        constexpr uint64_t continuation_bits = 0x8080808080808080;
+        uint64_t bits;
+        const unsigned available = bit_string_peek_bits(input_buffer, bits);
+        const uint64_t last_bytes = ~bits & continuation_bits & bit_string_low_mask(available & ~7u);
+        if(last_bytes != 0)
+        {
+            // Up to 8 bytes: keep the 7-bit groups of the bytes in the code and close the gaps between them.
+            const unsigned bit_count = bit_string_lowest_set_bit(last_bytes) + 1;
+            uint64_t code = bits & bit_string_low_mask(bit_count) & ~continuation_bits;
+            code = (code & 0x007F007F007F007F) | ((code & 0x7F007F007F007F00) >> 1);
+            code = (code & 0x00003FFF00003FFF) | ((code & 0x3FFF00003FFF0000) >> 2);
+            code = (code & 0x000000000FFFFFFF) | ((code & 0x0FFFFFFF00000000) >> 4);
+            value = bit_string_integer_from_code<integer_type>(code);
+            return bit_string_skip_bits(input_buffer, bit_count);
+        }
+        // Longer codes, or the end of the input: a byte at a time.
+        uint64_t code = 0;
+        for(unsigned shift = 0; shift < 64; shift += 7)
+        {
+            unsigned byte;
+            if(!bit_string_read_bits(input_buffer, byte, 8)) return false;
+            code |= uint64_t(byte & 0x7F) << shift;
+            if((byte & 0x80) == 0)
+            {
+                value = bit_string_integer_from_code<integer_type>(code);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    template <typename integer_type, typename output_backing_buffer_type>
+    bool bit_string_write_elias_gamma(bit_string_buffer_wrapper_type<output_backing_buffer_type>& output_buffer, integer_type value)
+    {
+        const uint64_t code = bit_string_code_from_integer(value);
+        const unsigned n = code == ~uint64_t{0} ? 64 : bit_string_highest_set_bit(code + 1);
+        const uint64_t remainder = code - bit_string_low_mask(n);
+        if(n < 32)
+            return bit_string_write_bits(output_buffer, (uint64_t{1} | (remainder << 1)) << n, 2 * n + 1);
+        return bit_string_write_unary(output_buffer, n) && bit_string_write_bits(output_buffer, remainder, n);
+    }
+
+    template <typename integer_type, typename input_backing_buffer_type>
+    bool bit_string_read_elias_gamma(bit_string_buffer_wrapper_type<input_backing_buffer_type>& input_buffer, integer_type& value)
+    {
+        uint64_t bits;
+        const unsigned available = bit_string_peek_bits(input_buffer, bits);
+        if(bits != 0)
+        {
+            const unsigned n = bit_string_lowest_set_bit(bits);
+            if(2 * n + 1 <= available)
+            {
+                value = bit_string_integer_from_code<integer_type>(bit_string_low_mask(n) + ((bits >> (n + 1)) & bit_string_low_mask(n)));
+                return bit_string_skip_bits(input_buffer, 2 * n + 1);
+            }
+        }
+        uint64_t n;
+        uint64_t remainder;
+        if(!bit_string_read_unary(input_buffer, n) || n > 64) return false;
+        if(!bit_string_read_bits(input_buffer, remainder, unsigned(n))) return false;
+        value = bit_string_integer_from_code<integer_type>(bit_string_low_mask(unsigned(n)) + remainder);
+        return true;
+    }
+
+    template <typename integer_type, typename output_backing_buffer_type>
+    bool bit_string_write_elias_delta(bit_string_buffer_wrapper_type<output_backing_buffer_type>& output_buffer, integer_type value)
+    {
+        const uint64_t code = bit_string_code_from_integer(value);
+        const unsigned n = code == ~uint64_t{0} ? 64 : bit_string_highest_set_bit(code + 1);
+        const uint64_t remainder = code - bit_string_low_mask(n);
+        const unsigned length_bits = bit_string_highest_set_bit(n + 1);
+        if(2 * length_bits + 1 + n <= 64)
+        {
+            const uint64_t length_code = (uint64_t{1} | ((n - bit_string_low_mask(length_bits)) << 1)) << length_bits;
+            return bit_string_write_bits(output_buffer, length_code | (remainder << (2 * length_bits + 1)), 2 * length_bits + 1 + n);
+        }
+        return bit_string_write_elias_gamma(output_buffer, n) && bit_string_write_bits(output_buffer, remainder, n);
+    }
+
+    template <typename integer_type, typename input_backing_buffer_type>
+    bool bit_string_read_elias_delta(bit_string_buffer_wrapper_type<input_backing_buffer_type>& input_buffer, integer_type& value)
+    {
+        uint64_t bits;
+        const unsigned available = bit_string_peek_bits(input_buffer, bits);
+        if(bits != 0)
+        {
+            const unsigned length_bits = bit_string_lowest_set_bit(bits);
+            const unsigned length_code_bits = 2 * length_bits + 1;
+            if(length_code_bits <= available)
+            {
+                const unsigned n = unsigned(bit_string_low_mask(length_bits) + ((bits >> (length_bits + 1)) & bit_string_low_mask(length_bits)));
+                if(length_code_bits + n <= available)
+                {
+                    value = bit_string_integer_from_code<integer_type>(bit_string_low_mask(n) + ((bits >> length_code_bits) & bit_string_low_mask(n)));
+                    return bit_string_skip_bits(input_buffer, length_code_bits + n);
+                }
+            }
+        }
+        unsigned n;
+        uint64_t remainder;
+        if(!bit_string_read_elias_gamma(input_buffer, n) || n > 64) return false;
+        if(!bit_string_read_bits(input_buffer, remainder, n)) return false;
+        value = bit_string_integer_from_code<integer_type>(bit_string_low_mask(n) + remainder);
+        return true;
+    }
+
+    // Longest unary run a Rice code may have, so a bad k cannot write (or a corrupt stream read) billions of zeros.
+    static const uint64_t bit_string_rice_max_quotient = 256;
+
+    template <typename integer_type, typename output_backing_buffer_type>
+    bool bit_string_write_rice(bit_string_buffer_wrapper_type<output_backing_buffer_type>& output_buffer, integer_type value, unsigned k)
+    {
+        if(k > 63) return false;
+        const uint64_t code = bit_string_code_from_integer(value);
+        const uint64_t quotient = code >> k;
+        if(quotient > bit_string_rice_max_quotient) return false;
+        const uint64_t remainder = code & bit_string_low_mask(k);
+        if(quotient + k < 64)
+            return bit_string_write_bits(output_buffer, (uint64_t{1} | (remainder << 1)) << quotient, unsigned(quotient) + 1 + k);
+        return bit_string_write_unary(output_buffer, quotient) && bit_string_write_bits(output_buffer, remainder, k);
+    }
+
+    template <typename integer_type, typename input_backing_buffer_type>
+    bool bit_string_read_rice(bit_string_buffer_wrapper_type<input_backing_buffer_type>& input_buffer, integer_type& value, unsigned k)
+    {
+        if(k > 63) return false;
+        uint64_t bits;
+        const unsigned available = bit_string_peek_bits(input_buffer, bits);
+        if(bits != 0)
+        {
+            const unsigned quotient = bit_string_lowest_set_bit(bits);
+            if(quotient + 1 + k <= available)
+            {
+                const uint64_t remainder = (bits >> quotient >> 1) & bit_string_low_mask(k);
+                value = bit_string_integer_from_code<integer_type>((uint64_t{quotient} << k) | remainder);
+                return bit_string_skip_bits(input_buffer, quotient + 1 + k);
+            }
+        }
+        uint64_t quotient;
+        uint64_t remainder;
+        if(!bit_string_read_unary(input_buffer, quotient) || quotient > bit_string_rice_max_quotient) return false;
+        if(!bit_string_read_bits(input_buffer, remainder, k)) return false;
+        value = bit_string_integer_from_code<integer_type>((quotient << k) | remainder);
+        return true;
+    }
+
     /*
     template <typename output_backing_buffer_type, typename value_type>
     bool bit_string_write_null_terminated_string(bit_string_buffer_wrapper_type<output_backing_buffer_type>& output_buffer, const value_type& input_value)
@@ -0,0 +1,357 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+#include "ATLUtil/bit_string.h"
+#include "ATLUtil/debug_break.h"
+
+namespace atl
+{
+    /*
+     * atl
+     * adaptive range coding
+     *
+     * A binary range coder (the LZMA arrangement: a 32-bit range, a 64-bit low with carry propagation through a
+     * cached byte) for data whose values are skewed in ways fixed bit widths cannot use, such as replay streams.
+     * Each value is coded against a model that learns its probabilities as it goes. Encoder and decoder must
+     * update identical models in the same order, so start both from fresh (or identically trained) models.
+     *
+     * Models:
+     * - range_coder_bit_model_type: one adaptive binary probability.
+     * - range_coder_symbol_model_type<symbol_count>: adaptive frequencies over a small alphabet (up to a few
+     *   dozen symbols; the coder scans the frequencies per symbol).
+     * - range_coder_ranged_integer_model_type<integer_type>: learned frequencies for an integer in [min, max], the
+     *   range coded counterpart of bit_string_write_ranged_integer. The top (up to 12) bits of value - min are
+     *   coded through a binary tree of bit models, so their whole joint distribution is learned; lower bits are
+     *   coded as equiprobable.
+     *
+     * Coded blocks live inside ordinary bit strings: the encoder pads the output to a byte boundary, then writes
+     * whole bytes through the backing buffer, and flush leaves it byte aligned again. The decoder reads exactly the
+     * bytes the encoder wrote, so bit_string reads and writes may continue after a block. If the output runs out,
+     * or the input is short, the coder carries on with nothing written or zeros read, and flush / finish return false.
+     */
+    static const unsigned range_coder_probability_bits = 11;
+    static const uint32_t range_coder_probability_one = uint32_t{1} << range_coder_probability_bits;
+    static const unsigned range_coder_adaptation_shift = 5;
+    static const uint32_t range_coder_top = uint32_t{1} << 24;
+
+    struct range_coder_bit_model_type
+    {
+        // The probability of a 0, out of range_coder_probability_one.
+        uint16_t probability = uint16_t(range_coder_probability_one / 2);
+    };
+
+    /*
+     range_coder_adapt: Moves a probability 1/32 of the way towards the bit just coded. Coded bits are usually
+     unpredictable (a tree of them codes one integer), so the coders select with masks rather than branch on them:
+     one_mask is all ones for a 1 bit and zero for a 0 bit.
+     */
+    inline uint16_t range_coder_adapt(uint32_t probability, uint32_t one_mask)
+    {
+        const uint32_t towards_zero = probability + ((range_coder_probability_one - probability) >> range_coder_adaptation_shift);
+        const uint32_t towards_one = probability - (probability >> range_coder_adaptation_shift);
+        return uint16_t(towards_zero ^ ((towards_zero ^ towards_one) & one_mask));
+    }
+
+    /*
+     range_coder_symbol_model_type: Each coded symbol gains increment; when the total passes max_total every
+     frequency is halved (keeping it above zero), so the model tracks recent statistics. A single frequency can
+     reach max_total + increment, so frequencies are 32 bits: a zero frequency would leave the coder no range.
+     */
+    template <unsigned symbol_count>
+    struct range_coder_symbol_model_type
+    {
+        static_assert(symbol_count >= 2 && symbol_count <= 256, "range_coder_symbol_model_type: use 2 to 256 symbols");
+        static constexpr uint32_t increment = 24;
+        static constexpr uint32_t max_total = uint32_t{1} << 16;
+
+        std::array<uint32_t, symbol_count> frequencies;
+        uint32_t total;
+
+        range_coder_symbol_model_type()
+        {
+            frequencies.fill(1);
+            total = symbol_count;
+        }
+
+        void update(unsigned symbol)
+        {
+            frequencies[symbol] += increment;
+            total += increment;
+            if(total > max_total)
+            {
+                total = 0;
+                for(uint32_t& frequency : frequencies)
+                {
+                    frequency = (frequency + 1) / 2;
+                    atl_fatal_assert(frequency != 0, "range_coder_symbol_model_type: a frequency reached zero");
+                    total += frequency;
+                }
+            }
+        }
+    };
+
+    template <typename integer_type>
+    struct range_coder_ranged_integer_model_type
+    {
+        static_assert(std::is_integral<integer_type>::value, "range_coder_ranged_integer_model_type: use an integer type");
+        using unsigned_type = typename std::make_unsigned<integer_type>::type;
+        static constexpr unsigned max_tree_bits = 12;
+
+        integer_type min;
+        integer_type max;
+        unsigned tree_bits;
+        unsigned direct_bits;
+        std::vector<range_coder_bit_model_type> tree;
+
+        range_coder_ranged_integer_model_type(integer_type in_min, integer_type in_max)
+            :
+            min(in_min),
+            max(in_max < in_min ? in_min : in_max)
+        {
+            const unsigned bit_count = unsigned(bits_required_for_integer(unsigned_type(unsigned_type(max) - unsigned_type(min))));
+            tree_bits = std::min(bit_count, max_tree_bits);
+            direct_bits = bit_count - tree_bits;
+            tree.resize(size_t{1} << tree_bits);
+        }
+    };
+
+    template <typename output_backing_buffer_type>
+    struct range_encoder_type
+    {
+        bit_string_buffer_wrapper_type<output_backing_buffer_type>* output;
+        uint64_t low;
+        uint32_t range;
+        uint8_t cache;
+        uint64_t cache_size;
+        bool ok;
+
+        explicit range_encoder_type(bit_string_buffer_wrapper_type<output_backing_buffer_type>& in_output)
+            :
+            output(&in_output),
+            low(0),
+            range(0xFFFFFFFF),
+            cache(0),
+            cache_size(1),
+            ok(bit_string_write_align_to_byte(in_output))
+        {}
+
+        void encode_bit(range_coder_bit_model_type& model, unsigned bit)
+        {
+            const uint32_t bound = (range >> range_coder_probability_bits) * model.probability;
+            const uint32_t one_mask = 0 - uint32_t(bit != 0);
+            low += bound & one_mask;
+            range = bound + ((range - 2 * bound) & one_mask);
+            model.probability = range_coder_adapt(model.probability, one_mask);
+            normalize();
+        }
+
+        // The low bit_count bits of value, most significant first, each with probability one half.
+        void encode_direct_bits(uint64_t value, unsigned bit_count)
+        {
+            while(bit_count > 0)
+            {
+                range >>= 1;
+                low += range & (0 - uint32_t((value >> --bit_count) & 1));
+                normalize();
+            }
+        }
+
+        template <unsigned symbol_count>
+        void encode_symbol(range_coder_symbol_model_type<symbol_count>& model, unsigned symbol)
+        {
+            uint32_t cumulative = 0;
+            for(unsigned i = 0; i < symbol; ++i)
+                cumulative += model.frequencies[i];
+            const uint32_t step = range / model.total;
+            low += uint64_t{step} * cumulative;
+            range = step * model.frequencies[symbol];
+            normalize();
+            model.update(symbol);
+        }
+
+        // Returns false, writing nothing, if value is outside the model's range.
+        template <typename integer_type>
+        bool encode_ranged_integer(range_coder_ranged_integer_model_type<integer_type>& model, integer_type value)
+        {
+            using unsigned_type = typename std::make_unsigned<integer_type>::type;
+            if(value < model.min || value > model.max) return false;
+            const unsigned_type offset = unsigned_type(unsigned_type(value) - unsigned_type(model.min));
+            const unsigned_type top = unsigned_type(offset >> model.direct_bits);
+            size_t node = 1;
+            for(unsigned i = model.tree_bits; i-- > 0;)
+            {
+                const unsigned bit = unsigned(top >> i) & 1;
+                encode_bit(model.tree[node], bit);
+                node = (node << 1) | bit;
+            }
+            encode_direct_bits(offset, model.direct_bits);
+            return true;
+        }
+
+        // Writes out the rest of the block. The output is then byte aligned.
+        bool flush()
+        {
+            for(unsigned i = 0; i < 5; ++i)
+                shift_low();
+            return ok;
+        }
+
+    private:
+        void normalize()
+        {
+            while(range < range_coder_top)
+            {
+                range <<= 8;
+                shift_low();
+            }
+        }
+
+        // Bytes are held back while they could still be changed by a carry: one cached byte and a run of 0xFF bytes.
+        void shift_low()
+        {
+            if(uint32_t(low) < 0xFF000000u || (low >> 32) != 0)
+            {
+                const uint8_t carry = uint8_t(low >> 32);
+                uint8_t byte = cache;
+                do
+                {
+                    put_byte(uint8_t(byte + carry));
+                    byte = 0xFF;
+                }
+                while(--cache_size != 0);
+                cache = uint8_t(low >> 24);
+            }
+            cache_size++;
+            low = (low & 0x00FFFFFF) << 8;
+        }
+
+        void put_byte(uint8_t byte)
+        {
+            const auto reserved = output->backing_buffer.reserve_bytes(1);
+            if(reserved.ptr == nullptr)
+            {
+                ok = false;
+                return;
+            }
+            *reserved.ptr = byte;
+            output->backing_buffer.advance(1);
+        }
+    };
+
+    template <typename input_backing_buffer_type>
+    struct range_decoder_type
+    {
+        bit_string_buffer_wrapper_type<input_backing_buffer_type>* input;
+        uint32_t range;
+        uint32_t code;
+        bool ok;
+
+        explicit range_decoder_type(bit_string_buffer_wrapper_type<input_backing_buffer_type>& in_input)
+            :
+            input(&in_input),
+            range(0xFFFFFFFF),
+            code(0),
+            ok(bit_string_read_align_to_byte(in_input))
+        {
+            for(unsigned i = 0; i < 5; ++i)
+                code = (code << 8) | get_byte();
+        }
+
+        unsigned decode_bit(range_coder_bit_model_type& model)
+        {
+            const uint32_t bound = (range >> range_coder_probability_bits) * model.probability;
+            const unsigned bit = code >= bound ? 1 : 0;
+            const uint32_t one_mask = 0 - uint32_t(bit);
+            code -= bound & one_mask;
+            range = bound + ((range - 2 * bound) & one_mask);
+            model.probability = range_coder_adapt(model.probability, one_mask);
+            normalize();
+            return bit;
+        }
+
+        uint64_t decode_direct_bits(unsigned bit_count)
+        {
+            uint64_t value = 0;
+            while(bit_count-- > 0)
+            {
+                range >>= 1;
+                // Branch-free: subtract half the range, and add it back if that went below zero.
+                code -= range;
+                const uint32_t borrow = 0 - (code >> 31);
+                code += range & borrow;
+                value = (value << 1) | (borrow + 1);
+                normalize();
+            }
+            return value;
+        }
+
+        template <unsigned symbol_count>
+        unsigned decode_symbol(range_coder_symbol_model_type<symbol_count>& model)
+        {
+            const uint32_t step = range / model.total;
+            const uint32_t target = std::min(code / step, model.total - 1);
+            unsigned symbol = 0;
+            uint32_t cumulative = 0;
+            while(cumulative + model.frequencies[symbol] <= target)
+                cumulative += model.frequencies[symbol++];
+            code -= step * cumulative;
+            range = step * model.frequencies[symbol];
+            normalize();
+            model.update(symbol);
+            return symbol;
+        }
+
+        template <typename integer_type>
+        integer_type decode_ranged_integer(range_coder_ranged_integer_model_type<integer_type>& model)
+        {
+            using unsigned_type = typename std::make_unsigned<integer_type>::type;
+            size_t node = 1;
+            for(unsigned i = 0; i < model.tree_bits; ++i)
+                node = (node << 1) | decode_bit(model.tree[node]);
+            const uint64_t top = node - (size_t{1} << model.tree_bits);
+            const uint64_t offset = (top << model.direct_bits) | decode_direct_bits(model.direct_bits);
+            return integer_type(unsigned_type(unsigned_type(model.min) + unsigned_type(offset)));
+        }
+
+        // True if every byte of the block was there to read.
+        bool finish() const { return ok; }
+
+    private:
+        void normalize()
+        {
+            while(range < range_coder_top)
+            {
+                range <<= 8;
+                code = (code << 8) | get_byte();
+            }
+        }
+
+        uint8_t get_byte()
+        {
+            const auto reserved = input->backing_buffer.reserve_bytes(1);
+            if(reserved.ptr == nullptr)
+            {
+                ok = false;
+                return 0;
+            }
+            const uint8_t byte = *reserved.ptr;
+            input->backing_buffer.advance(1);
+            return byte;
+        }
+    };
+
+    template <typename output_backing_buffer_type>
+    range_encoder_type<output_backing_buffer_type> make_range_encoder(bit_string_buffer_wrapper_type<output_backing_buffer_type>& output)
+    {
+        return range_encoder_type<output_backing_buffer_type>(output);
+    }
+
+    template <typename input_backing_buffer_type>
+    range_decoder_type<input_backing_buffer_type> make_range_decoder(bit_string_buffer_wrapper_type<input_backing_buffer_type>& input)
+    {
+        return range_decoder_type<input_backing_buffer_type>(input);
+    }
+}
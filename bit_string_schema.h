@@ -0,0 +1,238 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+#include "ATLUtil/bit_string.h"
+
+namespace atl
+{
+    /*
+     * atl
+     * compile-time bit_string schemas
+     *
+     * A message struct lists its fields once, as a bit_string_schema_type of field descriptors, instead of
+     * hand-writing a sequence of bit_string_write_* and bit_string_read_* calls:
+     *
+     *     struct player_update
+     *     {
+     *         uint16_t entity;
+     *         int32_t x, y;
+     *         float yaw;
+     *         bool alive;
+     *     };
+     *     using player_update_schema = bit_string_schema_type<
+     *         schema_ranged_field<&player_update::entity, 0, 4095>,
+     *         schema_ranged_field<&player_update::x, -32768, 32767>,
+     *         schema_ranged_field<&player_update::y, -32768, 32767>,
+     *         schema_value_field<&player_update::yaw>,
+     *         schema_value_field<&player_update::alive>>;
+     *
+     * Every field's width and bit offset is a compile-time constant, as is the message's total bit_count, so
+     * buffers for whole messages can be sized on the stack. write packs the fields into a stack staging block with
+     * one fixed-offset 64-bit read-modify-write each (an unrolled fold, with no loops or width checks at run time),
+     * then copies the block to the stream with a single bit_string_copy_bits; read does the reverse. The stream
+     * layout is the same as writing the fields one at a time in order with bit_string_write_bits.
+     *
+     * Field descriptors:
+     * - schema_bits_field<member, bit_count>: an unsigned integer member, in bit_count bits.
+     * - schema_ranged_field<member, min, max>: an integer member in [min, max], as its offset from min in
+     *   bits_required_for_integer(max - min) bits, IE as bit_string_write_ranged_integer writes it.
+     * - schema_value_field<member>: the raw bits of a trivially copyable member of up to 8 bytes (float, double,
+     *   any integer), or 1 bit for a bool.
+     * Writing checks that each value fits its field and returns false if one does not; the other fields are still
+     * written, and the out of range one is truncated.
+     */
+
+    template <typename struct_type, typename member_type>
+    member_type schema_member_type_of(member_type struct_type::*);
+
+    template <auto member>
+    using schema_member_type = decltype(schema_member_type_of(member));
+
+    // Deposits the low bit_count (up to 64) bits of value at bit_position of a zeroed staging block.
+    template <unsigned bit_position, unsigned bit_count>
+    inline void bit_string_schema_deposit(bit_string_byte_type* bytes, uint64_t value)
+    {
+        constexpr unsigned shift = bit_position % 8;
+        value &= bit_string_low_mask(bit_count);
+        bit_string_byte_type* first_byte = bytes + bit_position / 8;
+        bit_string_store_word(first_byte, bit_string_load_word(first_byte) | (value << shift));
+        if constexpr(bit_count + shift > 64)
+            first_byte[8] |= bit_string_byte_type(value >> (64 - shift));
+    }
+
+    template <unsigned bit_position, unsigned bit_count>
+    inline uint64_t bit_string_schema_extract(const bit_string_byte_type* bytes)
+    {
+        constexpr unsigned shift = bit_position % 8;
+        const bit_string_byte_type* first_byte = bytes + bit_position / 8;
+        uint64_t value = bit_string_load_word(first_byte) >> shift;
+        if constexpr(bit_count + shift > 64)
+            value |= uint64_t{first_byte[8]} << (64 - shift);
+        return value & bit_string_low_mask(bit_count);
+    }
+
+    template <auto member, unsigned field_bit_count>
+    struct schema_bits_field
+    {
+        using member_type = schema_member_type<member>;
+        static_assert(std::is_integral<member_type>::value && std::is_unsigned<member_type>::value, "schema_bits_field: use an unsigned integer member");
+        static_assert(field_bit_count <= sizeof(member_type) * 8, "schema_bits_field: more bits than the member has");
+        static constexpr unsigned bit_count = field_bit_count;
+
+        template <unsigned bit_position, typename struct_type>
+        static bool pack(const struct_type& value, bit_string_byte_type* bytes)
+        {
+            const uint64_t field = uint64_t(value.*member);
+            bit_string_schema_deposit<bit_position, bit_count>(bytes, field);
+            return bit_count >= 64 || (field >> (bit_count % 64)) == 0;
+        }
+
+        template <unsigned bit_position, typename struct_type>
+        static void unpack(const bit_string_byte_type* bytes, struct_type& value)
+        {
+            value.*member = member_type(bit_string_schema_extract<bit_position, bit_count>(bytes));
+        }
+    };
+
+    template <auto member, auto min, auto max>
+    struct schema_ranged_field
+    {
+        using member_type = schema_member_type<member>;
+        using unsigned_type = typename std::make_unsigned<member_type>::type;
+        static_assert(std::is_integral<member_type>::value && !std::is_same<member_type, bool>::value, "schema_ranged_field: use an integer member");
+        static_assert(member_type(min) == min && member_type(max) == max, "schema_ranged_field: range does not fit the member");
+        static_assert(min <= max, "schema_ranged_field: min is greater than max");
+        static constexpr unsigned_type range = unsigned_type(unsigned_type(member_type(max)) - unsigned_type(member_type(min)));
+        static constexpr unsigned bit_count = unsigned(bits_required_for_integer(range));
+
+        template <unsigned bit_position, typename struct_type>
+        static bool pack(const struct_type& value, bit_string_byte_type* bytes)
+        {
+            const unsigned_type offset = unsigned_type(unsigned_type(value.*member) - unsigned_type(member_type(min)));
+            if constexpr(bit_count > 0)
+                bit_string_schema_deposit<bit_position, bit_count>(bytes, offset);
+            return offset <= range;
+        }
+
+        template <unsigned bit_position, typename struct_type>
+        static void unpack(const bit_string_byte_type* bytes, struct_type& value)
+        {
+            unsigned_type offset = 0;
+            if constexpr(bit_count > 0)
+                offset = unsigned_type(bit_string_schema_extract<bit_position, bit_count>(bytes));
+            value.*member = member_type(unsigned_type(unsigned_type(member_type(min)) + offset));
+        }
+    };
+
+    template <auto member>
+    struct schema_value_field
+    {
+        using member_type = schema_member_type<member>;
+        static_assert(std::is_trivially_copyable<member_type>::value && sizeof(member_type) <= 8, "schema_value_field: use a trivially copyable member of up to 8 bytes");
+        static constexpr unsigned bit_count = std::is_same<member_type, bool>::value ? 1 : unsigned(sizeof(member_type) * 8);
+
+        template <unsigned bit_position, typename struct_type>
+        static bool pack(const struct_type& value, bit_string_byte_type* bytes)
+        {
+            uint64_t field = 0;
+            if constexpr(std::is_same<member_type, bool>::value)
+                field = value.*member ? 1 : 0;
+            else
+                std::memcpy(&field, &(value.*member), sizeof(member_type));
+            bit_string_schema_deposit<bit_position, bit_count>(bytes, field);
+            return true;
+        }
+
+        template <unsigned bit_position, typename struct_type>
+        static void unpack(const bit_string_byte_type* bytes, struct_type& value)
+        {
+            const uint64_t field = bit_string_schema_extract<bit_position, bit_count>(bytes);
+            if constexpr(std::is_same<member_type, bool>::value)
+                value.*member = field != 0;
+            else
+                std::memcpy(&(value.*member), &field, sizeof(member_type));
+        }
+    };
+
+    template <typename... field_types>
+    struct bit_string_schema_type
+    {
+        static constexpr unsigned bit_count = (0u + ... + field_types::bit_count);
+        static constexpr unsigned byte_count = (bit_count + 7) / 8;
+        // Staging blocks are padded so that every field is one 64-bit load or store (plus a byte for 64-bit fields).
+        static constexpr unsigned staging_byte_count = byte_count + 9;
+
+        static constexpr unsigned field_bit_position(size_t index)
+        {
+            const unsigned bit_counts[] = {0u, field_types::bit_count...};
+            unsigned position = 0;
+            for(size_t i = 1; i <= index; ++i)
+                position += bit_counts[i];
+            return position;
+        }
+
+        /*
+         pack / unpack: The message as bit_count bits at the start of bytes, which must hold staging_byte_count
+         bytes; pack needs them zeroed.
+         */
+        template <typename struct_type>
+        static bool pack(const struct_type& value, bit_string_byte_type* bytes)
+        {
+            return pack_fields(value, bytes, std::index_sequence_for<field_types...>());
+        }
+
+        template <typename struct_type>
+        static void unpack(const bit_string_byte_type* bytes, struct_type& value)
+        {
+            unpack_fields(bytes, value, std::index_sequence_for<field_types...>());
+        }
+
+        template <typename struct_type, typename output_backing_buffer_type>
+        static bool write(bit_string_buffer_wrapper_type<output_backing_buffer_type>& output_buffer, const struct_type& value)
+        {
+            bit_string_byte_type staging[staging_byte_count] = {};
+            const bool in_range = pack(value, staging);
+            auto input_buffer = bit_string_wrap_backing_buffer(simple_backing_buffer(staging, byte_count));
+            return bit_string_copy_bits(input_buffer, output_buffer, bit_count) && in_range;
+        }
+
+        template <typename struct_type, typename input_backing_buffer_type>
+        static bool read(bit_string_buffer_wrapper_type<input_backing_buffer_type>& input_buffer, struct_type& value)
+        {
+            bit_string_byte_type staging[staging_byte_count] = {};
+            auto output_buffer = bit_string_wrap_backing_buffer(simple_backing_buffer(staging, byte_count));
+            if(!bit_string_copy_bits(input_buffer, output_buffer, bit_count)) return false;
+            unpack(staging, value);
+            return true;
+        }
+
+    private:
+        template <typename struct_type, size_t... indices>
+        static bool pack_fields(const struct_type& value, bit_string_byte_type* bytes, std::index_sequence<indices...>)
+        {
+            return (true & ... & field_types::template pack<field_bit_position(indices)>(value, bytes));
+        }
+
+        template <typename struct_type, size_t... indices>
+        static void unpack_fields(const bit_string_byte_type* bytes, struct_type& value, std::index_sequence<indices...>)
+        {
+            (field_types::template unpack<field_bit_position(indices)>(bytes, value), ...);
+        }
+    };
+
+    template <typename schema_type, typename struct_type, typename output_backing_buffer_type>
+    bool bit_string_write_schema(bit_string_buffer_wrapper_type<output_backing_buffer_type>& output_buffer, const struct_type& value)
+    {
+        return schema_type::write(output_buffer, value);
+    }
+
+    template <typename schema_type, typename struct_type, typename input_backing_buffer_type>
+    bool bit_string_read_schema(bit_string_buffer_wrapper_type<input_backing_buffer_type>& input_buffer, struct_type& value)
+    {
+        return schema_type::read(input_buffer, value);
+    }
+}
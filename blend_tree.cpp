@@ -0,0 +1,156 @@
+
+#include "blend_tree.h"
+#include "debug_break.h"
+#include <algorithm>
+#include <thread>
+
+atl::bone_transform_type atl::blend_bone_transforms(const bone_transform_type & a, const bone_transform_type & b, float weight)
+{
+	bone_transform_type result;
+	result.translation = a.translation + (b.translation - a.translation) * weight;
+	result.scale = a.scale + (b.scale - a.scale) * weight;
+	// q and -q are the same rotation; pick the one that makes the shorter arc.
+	const quatf b_rotation = a.rotation.dot(b.rotation) < 0.f ? -b.rotation : b.rotation;
+	result.rotation = a.rotation.slerp(b_rotation, weight);
+	return result;
+}
+
+atl::matrix4f atl::bone_transform_matrix(const bone_transform_type & transform)
+{
+	const quatf & q = transform.rotation;
+	const point3f & s = transform.scale;
+	const point3f & t = transform.translation;
+	return {
+		(1.f - 2.f * (q.y * q.y + q.z * q.z)) * s.x, 2.f * (q.x * q.y + q.z * q.w) * s.x, 2.f * (q.x * q.z - q.y * q.w) * s.x, 0.f,
+		2.f * (q.x * q.y - q.z * q.w) * s.y, (1.f - 2.f * (q.x * q.x + q.z * q.z)) * s.y, 2.f * (q.y * q.z + q.x * q.w) * s.y, 0.f,
+		2.f * (q.x * q.z + q.y * q.w) * s.z, 2.f * (q.y * q.z - q.x * q.w) * s.z, (1.f - 2.f * (q.x * q.x + q.y * q.y)) * s.z, 0.f,
+		t.x, t.y, t.z, 1.f
+	};
+}
+
+void atl::pose_clip_type::sample(float t, region_type<bone_transform_type> out_pose) const
+{
+	const uint32_t count = frame_count();
+	if(count == 0)
+	{
+		std::fill(out_pose.begin(), out_pose.begin() + bone_count, bone_transform_type());
+		return;
+	}
+	const float frame = clamp(t * frame_rate, 0.f, float(count - 1));
+	const uint32_t first = std::min(uint32_t(frame), count > 1 ? count - 2 : 0);
+	const uint32_t second = std::min(first + 1, count - 1);
+	const float weight = frame - float(first);
+	const bone_transform_type * a = frames.data() + size_t(first) * bone_count;
+	const bone_transform_type * b = frames.data() + size_t(second) * bone_count;
+	bone_transform_type * out = out_pose.begin();
+	for(uint32_t i = 0; i < bone_count; ++i)
+		out[i] = blend_bone_transforms(a[i], b[i], weight);
+}
+
+namespace
+{
+	void apply_additive(const atl::bone_transform_type & delta, float weight, atl::bone_transform_type & io_base)
+	{
+		const atl::bone_transform_type weighted = atl::blend_bone_transforms(atl::bone_transform_type(), delta, weight);
+		io_base.translation += weighted.translation;
+		io_base.rotation = io_base.rotation * weighted.rotation;
+		io_base.scale = atl::point3f(io_base.scale.x * weighted.scale.x, io_base.scale.y * weighted.scale.y, io_base.scale.z * weighted.scale.z);
+	}
+}
+
+void atl::evaluate_blend_tree(const blend_tree_type & tree, region_type<const float> parameters, region_stack_type<bone_transform_type> & scratch, region_type<bone_transform_type> out_pose)
+{
+	atl_fatal_assert(tree.valid(), "evaluate_blend_tree called with an incomplete tree or mismatched clips");
+	const size_t bone_count = tree.skeleton->bone_count();
+	const float * parameter_values = parameters.begin();
+	bone_transform_type * const stack_base = scratch.end();
+	for(const auto & node : tree.nodes)
+	{
+		if(node.kind == blend_node_kind::clip)
+		{
+			tree.clips[node.clip]->sample(parameter_values[node.parameter], scratch.push(bone_count));
+			continue;
+		}
+		// Combine the top pose into the one below it, in place, then drop the top.
+		bone_transform_type * top = scratch.end() - bone_count;
+		bone_transform_type * below = top - bone_count;
+		const float weight = parameter_values[node.parameter];
+		if(node.kind == blend_node_kind::lerp)
+		{
+			for(size_t i = 0; i < bone_count; ++i)
+				below[i] = blend_bone_transforms(below[i], top[i], weight);
+		}
+		else
+		{
+			for(size_t i = 0; i < bone_count; ++i)
+				apply_additive(top[i], weight, below[i]);
+		}
+		scratch.pop(bone_count);
+	}
+	std::copy(stack_base, stack_base + bone_count, out_pose.begin());
+	scratch.pop(bone_count);
+}
+
+void atl::compute_skinning_palette(const skeleton_type & skeleton, region_type<const bone_transform_type> local_pose, region_type<matrix4f> out_palette)
+{
+	const size_t bone_count = skeleton.bone_count();
+	const bone_transform_type * local = local_pose.begin();
+	matrix4f * palette = out_palette.begin();
+	// Model space transforms first, built in place since parents come before children:
+	for(size_t i = 0; i < bone_count; ++i)
+	{
+		const int32_t parent = skeleton.parents[i];
+		const matrix4f local_matrix = bone_transform_matrix(local[i]);
+		palette[i] = parent < 0 ? local_matrix : palette[parent].transform(local_matrix);
+	}
+	for(size_t i = 0; i < bone_count; ++i)
+		palette[i] = palette[i].transform(skeleton.inverse_bind_matrices[i]);
+}
+
+void atl::evaluate_blend_character(blend_character_type & character, region_stack_type<bone_transform_type> & scratch)
+{
+	const blend_tree_type & tree = *character.tree;
+	const size_t bone_count = tree.skeleton->bone_count();
+	character.palette.resize(bone_count);
+	region_type<bone_transform_type> pose = scratch.push(bone_count);
+	evaluate_blend_tree(tree, region_n(static_cast<const float *>(character.parameters.data()), character.parameters.size()), scratch, pose);
+	compute_skinning_palette(*tree.skeleton, pose, region_n(character.palette.data(), bone_count));
+	scratch.pop(bone_count);
+}
+
+void atl::blend_evaluator_type::evaluate(region_type<blend_character_type> characters, unsigned thread_count)
+{
+	const size_t character_count = size_t(characters.size());
+	if(character_count == 0)
+		return;
+	thread_count = unsigned(std::max<size_t>(1, std::min<size_t>(thread_count, character_count)));
+
+	size_t scratch_size = 0;
+	for(const auto & character : characters)
+		scratch_size = std::max(scratch_size, blend_scratch_size(*character.tree) + character.tree->skeleton->bone_count());
+	if(thread_scratch.size() < thread_count)
+		thread_scratch.resize(thread_count);
+	for(unsigned i = 0; i < thread_count; ++i)
+	{
+		if(thread_scratch[i].size() < scratch_size)
+			thread_scratch[i].resize(scratch_size);
+	}
+
+	auto evaluate_range = [this, characters, character_count, thread_count](unsigned thread_index)
+	{
+		const size_t begin = character_count * thread_index / thread_count;
+		const size_t end = character_count * (thread_index + 1) / thread_count;
+		std::vector<bone_transform_type> & storage = thread_scratch[thread_index];
+		region_stack_type<bone_transform_type> scratch(region_n(storage.data(), storage.size()));
+		for(size_t i = begin; i < end; ++i)
+			evaluate_blend_character(characters.begin()[i], scratch);
+	};
+
+	std::vector<std::thread> threads;
+	threads.reserve(thread_count - 1);
+	for(unsigned i = 1; i < thread_count; ++i)
+		threads.emplace_back(evaluate_range, i);
+	evaluate_range(0);
+	for(auto & thread : threads)
+		thread.join();
+}
@@ -0,0 +1,184 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "ATLUtil/math3d.h"
+#include "ATLUtil/region.h"
+#include "ATLUtil/region_stack.h"
+
+namespace atl
+{
+	/*
+	 * atl
+	 * skeletal pose blending
+	 *
+	 * Poses are arrays of local (parent-relative) bone transforms. Clips are baked to one pose per frame,
+	 * blend trees combine clip samples, and the result is turned into a skinning palette of matrix4f,
+	 * model_space(bone) * inverse_bind(bone), laid out like the rest of math3d (m[column][row]).
+	 *
+	 * Tree evaluation never allocates: intermediate poses are pushed on a region_stack_type of
+	 * bone_transform_type that the caller sizes once with blend_scratch_size and reuses every frame.
+	 */
+
+	struct bone_transform_type
+	{
+		point3f translation = point3f(0.f, 0.f, 0.f);
+		quatf rotation = quatf(0.f, 0.f, 0.f, 1.f);
+		point3f scale = point3f(1.f, 1.f, 1.f);
+	};
+
+	// Lerps translation and scale, slerps rotation along the shorter arc.
+	bone_transform_type blend_bone_transforms(const bone_transform_type & a, const bone_transform_type & b, float weight);
+
+	// translation * rotation * scale
+	matrix4f bone_transform_matrix(const bone_transform_type & transform);
+
+	/*
+	 skeleton_type: Parent indices (-1 for roots) and inverse bind matrices. Parents must come before their children.
+	 */
+	struct skeleton_type
+	{
+		std::vector<int32_t> parents;
+		std::vector<matrix4f> inverse_bind_matrices;
+
+		size_t bone_count() const { return parents.size(); }
+	};
+
+	/*
+	 pose_clip_type: A clip baked to a full local pose per frame, stored frame after frame.
+	 */
+	struct pose_clip_type
+	{
+		uint32_t bone_count = 0;
+		float frame_rate = 30.f;
+		std::vector<bone_transform_type> frames;
+
+		uint32_t frame_count() const { return bone_count == 0 ? 0 : uint32_t(frames.size() / bone_count); }
+		float duration() const { return frame_count() < 2 ? 0.f : float(frame_count() - 1) / frame_rate; }
+
+		// Blends the two frames around time t, clamped to the clip. Loop by wrapping t before calling.
+		// A clip with no frames gives the identity pose.
+		void sample(float t, region_type<bone_transform_type> out_pose) const;
+	};
+
+	enum class blend_node_kind : uint8_t
+	{
+		clip,
+		lerp,
+		additive
+	};
+
+	struct blend_node_type
+	{
+		blend_node_kind kind;
+		// clip nodes only:
+		uint32_t clip;
+		// Index into the character's parameters: sample time for clip nodes, weight for the others.
+		uint32_t parameter;
+	};
+
+	/*
+	 blend_tree_type: A blend tree stored in post-order, so it evaluates as a stack machine:
+	 add_clip pushes a pose, add_lerp and add_additive combine the two poses on top into one.
+	 For example lerp(walk, run) with an additive lean on top is
+	   add_clip(walk, 0); add_clip(run, 1); add_lerp(2); add_clip(lean, 3); add_additive(4);
+	 Additive clips hold deltas from the identity transform, which are applied on top of the base pose scaled by weight.
+	 The tree is complete when exactly one pose is left, and usable when every clip node names a clip in clips with the
+	 skeleton's bone count; valid() checks both.
+	 */
+	struct blend_tree_type
+	{
+		const skeleton_type * skeleton = nullptr;
+		std::vector<const pose_clip_type *> clips;
+		std::vector<blend_node_type> nodes;
+
+		uint32_t add_clip(uint32_t clip_index, uint32_t time_parameter)
+		{
+			nodes.push_back({blend_node_kind::clip, clip_index, time_parameter});
+			internal_depth++;
+			if(internal_depth > internal_max_depth) internal_max_depth = internal_depth;
+			return uint32_t(nodes.size() - 1);
+		}
+
+		uint32_t add_lerp(uint32_t weight_parameter) { return add_combine(blend_node_kind::lerp, weight_parameter); }
+		uint32_t add_additive(uint32_t weight_parameter) { return add_combine(blend_node_kind::additive, weight_parameter); }
+
+		bool valid() const
+		{
+			if(skeleton == nullptr || internal_depth != 1 || internal_underflow)
+				return false;
+			// Clips write bone_count entries into poses sized for the skeleton:
+			for(const auto & node : nodes)
+			{
+				if(node.kind == blend_node_kind::clip &&
+				   (node.clip >= clips.size() || clips[node.clip] == nullptr || clips[node.clip]->bone_count != skeleton->bone_count()))
+					return false;
+			}
+			return true;
+		}
+
+		// Number of poses live at once while evaluating.
+		uint32_t max_depth() const { return internal_max_depth; }
+
+	private:
+		uint32_t add_combine(blend_node_kind kind, uint32_t weight_parameter)
+		{
+			nodes.push_back({kind, 0, weight_parameter});
+			if(internal_depth < 2) internal_underflow = true;
+			else internal_depth--;
+			return uint32_t(nodes.size() - 1);
+		}
+
+		uint32_t internal_depth = 0;
+		uint32_t internal_max_depth = 0;
+		bool internal_underflow = false;
+	};
+
+	// Scratch elements needed to evaluate tree.
+	inline size_t blend_scratch_size(const blend_tree_type & tree)
+	{
+		return size_t(tree.max_depth()) * tree.skeleton->bone_count();
+	}
+
+	/*
+	 evaluate_blend_tree: Writes the blended local pose to out_pose (bone_count entries).
+	 tree must be valid(). scratch needs blend_scratch_size(tree) free elements; it is left as it was found.
+	 */
+	void evaluate_blend_tree(const blend_tree_type & tree, region_type<const float> parameters, region_stack_type<bone_transform_type> & scratch, region_type<bone_transform_type> out_pose);
+
+	/*
+	 compute_skinning_palette: Concatenates local transforms down the hierarchy and applies the inverse bind matrices.
+	 out_palette needs bone_count entries.
+	 */
+	void compute_skinning_palette(const skeleton_type & skeleton, region_type<const bone_transform_type> local_pose, region_type<matrix4f> out_palette);
+
+	/*
+	 blend_character_type: One animated instance: the tree it plays, its parameter values for this frame, and its palette.
+	 */
+	struct blend_character_type
+	{
+		const blend_tree_type * tree = nullptr;
+		std::vector<float> parameters;
+		std::vector<matrix4f> palette;
+	};
+
+	/*
+	 evaluate_blend_character: Evaluates the character's tree and fills its palette (resized to the bone count).
+	 scratch needs blend_scratch_size(tree) + bone_count free elements.
+	 */
+	void evaluate_blend_character(blend_character_type & character, region_stack_type<bone_transform_type> & scratch);
+
+	/*
+	 blend_evaluator_type: Evaluates many characters across threads, each thread with its own scratch arena.
+	 Characters are independent, so they are split into one contiguous range per thread; the calling thread takes
+	 the first range. Arenas only grow, so after the first frame evaluation does not allocate apart from starting threads.
+	 To run on an existing job system instead, hand out ranges of characters and call evaluate_blend_character
+	 with one arena per worker.
+	 */
+	struct blend_evaluator_type
+	{
+		std::vector<std::vector<bone_transform_type>> thread_scratch;
+
+		void evaluate(region_type<blend_character_type> characters, unsigned thread_count);
+	};
+}
@@ -0,0 +1,78 @@
+
+#include "color.h"
+
+/*
+ The loops below read and write whole structs channel by channel with no branches, so the compiler can vectorize
+ them (byte <-> float widening, one multiply, integer clamp).
+ */
+
+void atl::convert_colors(region_type<const color32> in_colors, region_type<color> out_colors)
+{
+    const auto l_count = in_colors.size();
+    const color32 * l_in = in_colors.begin();
+    color * l_out = out_colors.begin();
+    for(std::ptrdiff_t i = 0; i < l_count; ++i)
+    {
+        l_out[i].r = float(l_in[i].r) * (1.f / 255.f);
+        l_out[i].g = float(l_in[i].g) * (1.f / 255.f);
+        l_out[i].b = float(l_in[i].b) * (1.f / 255.f);
+        l_out[i].a = float(l_in[i].a) * (1.f / 255.f);
+    }
+}
+
+void atl::convert_colors(region_type<const color> in_colors, region_type<color32> out_colors)
+{
+    const auto l_count = in_colors.size();
+    const color * l_in = in_colors.begin();
+    color32 * l_out = out_colors.begin();
+    for(std::ptrdiff_t i = 0; i < l_count; ++i)
+    {
+        l_out[i].r = color32::to_byte(l_in[i].r);
+        l_out[i].g = color32::to_byte(l_in[i].g);
+        l_out[i].b = color32::to_byte(l_in[i].b);
+        l_out[i].a = color32::to_byte(l_in[i].a);
+    }
+}
+
+void atl::convert_colors(region_type<const color32> in_colors, region_type<color_premul> out_colors)
+{
+    const auto l_count = in_colors.size();
+    const color32 * l_in = in_colors.begin();
+    color_premul * l_out = out_colors.begin();
+    for(std::ptrdiff_t i = 0; i < l_count; ++i)
+    {
+        l_out[i].r = float(l_in[i].r) * (1.f / 255.f);
+        l_out[i].g = float(l_in[i].g) * (1.f / 255.f);
+        l_out[i].b = float(l_in[i].b) * (1.f / 255.f);
+        l_out[i].a = float(l_in[i].a) * (1.f / 255.f);
+    }
+}
+
+void atl::convert_colors(region_type<const color_premul> in_colors, region_type<color32> out_colors)
+{
+    const auto l_count = in_colors.size();
+    const color_premul * l_in = in_colors.begin();
+    color32 * l_out = out_colors.begin();
+    for(std::ptrdiff_t i = 0; i < l_count; ++i)
+    {
+        l_out[i].r = color32::to_byte(l_in[i].r);
+        l_out[i].g = color32::to_byte(l_in[i].g);
+        l_out[i].b = color32::to_byte(l_in[i].b);
+        l_out[i].a = color32::to_byte(l_in[i].a);
+    }
+}
+
+void atl::premultiply_colors(region_type<const color32> in_colors, region_type<color_premul> out_colors)
+{
+    const auto l_count = in_colors.size();
+    const color32 * l_in = in_colors.begin();
+    color_premul * l_out = out_colors.begin();
+    for(std::ptrdiff_t i = 0; i < l_count; ++i)
+    {
+        const float l_alpha = float(l_in[i].a) * (1.f / 255.f);
+        l_out[i].r = float(l_in[i].r) * (1.f / 255.f) * l_alpha;
+        l_out[i].g = float(l_in[i].g) * (1.f / 255.f) * l_alpha;
+        l_out[i].b = float(l_in[i].b) * (1.f / 255.f) * l_alpha;
+        l_out[i].a = l_alpha;
+    }
+}
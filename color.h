@@ -2,7 +2,10 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cstdint>
 #include "basic_math.h"
+#include "region.h"
 
 namespace atl
 {
@@ -165,6 +168,9 @@ namespace atl
         float b;
         float a;
         
+        color_premul()
+        {}
+        
         color_premul(unsigned char in_r, unsigned char in_g, unsigned char in_b, unsigned char in_a) :
         r(float(in_r) * (1.f / 255.f)),
         g(float(in_g) * (1.f / 255.f)),
@@ -239,6 +245,85 @@ namespace atl
         }
     };
     
+    /*
+     color32: Packed 8 bit per channel color, stored r, g, b, a in memory (RGBA8).
+     Float to byte conversion clamps to [0, 1] and rounds to nearest, so byte -> float -> byte is exact.
+     Whether the channels are premultiplied is up to the user, as with color and color_premul.
+     */
+    class color32
+    {
+    public:
+        uint8_t r;
+        uint8_t g;
+        uint8_t b;
+        uint8_t a;
+        
+        color32()
+        {}
+        
+        constexpr color32(uint8_t in_r, uint8_t in_g, uint8_t in_b, uint8_t in_a = 255) :
+        r(in_r),
+        g(in_g),
+        b(in_b),
+        a(in_a)
+        {}
+        
+        explicit color32(const color & in_color) :
+        r(to_byte(in_color.r)),
+        g(to_byte(in_color.g)),
+        b(to_byte(in_color.b)),
+        a(to_byte(in_color.a))
+        {}
+        
+        explicit color32(const color_premul & in_color) :
+        r(to_byte(in_color.r)),
+        g(to_byte(in_color.g)),
+        b(to_byte(in_color.b)),
+        a(to_byte(in_color.a))
+        {}
+        
+        color to_color() const
+        {
+            return color(r, g, b, a);
+        }
+        
+        color_premul to_color_premul() const
+        {
+            return color_premul(r, g, b, a);
+        }
+        
+        bool operator == (const color32 & in_otherColor) const
+        {
+            return r == in_otherColor.r && g == in_otherColor.g && b == in_otherColor.b && a == in_otherColor.a;
+        }
+        
+        bool operator != (const color32 & in_otherColor) const
+        {
+            return !((*this) == in_otherColor);
+        }
+        
+        // Clamp and round to nearest. Clamps the float before converting it, so any input is safe (NaN gives 0).
+        // Clamping the scaled value, rather than in_value to [0, 1], is the form that loops over it vectorize.
+        static uint8_t to_byte(float in_value)
+        {
+            const float l_value = std::min(255.5f, std::max(0.f, in_value * 255.f + 0.5f));
+            return uint8_t(int32_t(l_value));
+        }
+    };
+    
+    static_assert(sizeof(color32) == 4, "color32 must pack into four bytes");
+    
+    /*
+     Bulk conversions between color32 and float colors. out must be at least as long as in.
+     Byte channels are converted as they are: premultiplied bytes give a correct color_premul, straight bytes a correct color.
+     premultiply_colors converts straight bytes to color_premul, multiplying by alpha in float.
+     */
+    void convert_colors(region_type<const color32> in_colors, region_type<color> out_colors);
+    void convert_colors(region_type<const color> in_colors, region_type<color32> out_colors);
+    void convert_colors(region_type<const color32> in_colors, region_type<color_premul> out_colors);
+    void convert_colors(region_type<const color_premul> in_colors, region_type<color32> out_colors);
+    void premultiply_colors(region_type<const color32> in_colors, region_type<color_premul> out_colors);
+    
     static const atl::color_gray color_black = atl::color_gray(0.f);
     static const atl::color_gray color_white = atl::color_gray(1.f);
 }
@@ -0,0 +1,264 @@
+
+#include "color_space.h"
+#include <array>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+    /*
+     Piecewise linear approximation of a curve on [0, 1], bucketed by float bits: each octave from 2^-first_octave
+     to 1 is split into 2^mantissa_bits buckets, which keeps the relative error about the same from black to white.
+     Inputs below the first bucket fall into it, and it is stretched down to 0; both sRGB curves are linear there.
+     */
+    struct transfer_table_type
+    {
+        static const int mantissa_bits = 6;
+        static const int first_octave = 12;
+        static const int bucket_count = first_octave << mantissa_bits;
+        static const int32_t first_bucket_bits = (127 - first_octave) << 23;
+
+        // One 16 byte entry per bucket, so a lookup touches a single cache line.
+        struct segment_type
+        {
+            float start, base, slope, unused;
+        };
+        std::array<segment_type, bucket_count> segments;
+
+        template <typename curve_type>
+        explicit transfer_table_type(const curve_type & in_curve)
+        {
+            for(int i = 0; i < bucket_count; ++i)
+            {
+                const float l_start = i == 0 ? 0.f : bucket_start(i);
+                const float l_end = bucket_start(i + 1);
+                const float l_base = in_curve(l_start);
+                segments[i] = {l_start, l_base, (in_curve(l_end) - l_base) / (l_end - l_start), 0.f};
+            }
+        }
+
+        static float bucket_start(int in_bucket)
+        {
+            const int32_t l_bits = first_bucket_bits + (in_bucket << (23 - mantissa_bits));
+            float l_value;
+            std::memcpy(&l_value, &l_bits, sizeof(float));
+            return l_value;
+        }
+
+        // Branch-free (integer clamps only), so loops over it can vectorize where the target has gathers.
+        float operator()(float in_value) const
+        {
+            int32_t l_bits;
+            std::memcpy(&l_bits, &in_value, sizeof(float));
+            // Negative inputs (-0 included) have negative bits and go to the first bucket with tiny ones, which also
+            // keeps the subtraction from overflowing.
+            int32_t l_index = l_bits < first_bucket_bits ? 0 : (l_bits - first_bucket_bits) >> (23 - mantissa_bits);
+            l_index = l_index > bucket_count - 1 ? bucket_count - 1 : l_index;
+            const segment_type & l_segment = segments[l_index];
+            return l_segment.base + (in_value - l_segment.start) * l_segment.slope;
+        }
+    };
+
+    const transfer_table_type & decode_table()
+    {
+        static const transfer_table_type s_table([](float in_value) { return atl::srgb_to_linear(in_value); });
+        return s_table;
+    }
+
+    const transfer_table_type & encode_table()
+    {
+        static const transfer_table_type s_table([](float in_value) { return atl::linear_to_srgb(in_value); });
+        return s_table;
+    }
+
+    const std::array<float, 256> & byte_decode_table()
+    {
+        static const std::array<float, 256> s_table = []() {
+            std::array<float, 256> l_table;
+            for(int i = 0; i < 256; ++i)
+                l_table[i] = atl::srgb_to_linear(float(i) * (1.f / 255.f));
+            return l_table;
+        }();
+        return s_table;
+    }
+
+    // Hue as a fraction of a turn, from the channel extremes (shared by HSV and HSL).
+    float hue_of(const atl::color & in_color, float in_max, float in_delta)
+    {
+        if(in_delta <= 0.f)
+            return 0.f;
+        float l_hue;
+        if(in_max == in_color.r)
+            l_hue = (in_color.g - in_color.b) / in_delta;
+        else if(in_max == in_color.g)
+            l_hue = (in_color.b - in_color.r) / in_delta + 2.f;
+        else
+            l_hue = (in_color.r - in_color.g) / in_delta + 4.f;
+        l_hue *= 1.f / 6.f;
+        return l_hue < 0.f ? l_hue + 1.f : l_hue;
+    }
+
+    float wrap_unit(float in_value)
+    {
+        return in_value - std::floor(in_value);
+    }
+
+    // One channel of HSV to RGB, without branching on the hue sextant; in_offset is 5, 3 or 1 for r, g, b.
+    float hsv_channel(const atl::color_hsv & in_color, float in_offset)
+    {
+        float l_k = in_offset + wrap_unit(in_color.h) * 6.f;
+        l_k = l_k >= 6.f ? l_k - 6.f : l_k;
+        const float l_ramp = std::fmax(0.f, std::fmin(std::fmin(l_k, 4.f - l_k), 1.f));
+        return in_color.v - in_color.v * in_color.s * l_ramp;
+    }
+
+    // One channel of HSL to RGB; in_offset is 0, 8 or 4 for r, g, b.
+    float hsl_channel(const atl::color_hsl & in_color, float in_offset)
+    {
+        float l_k = in_offset + wrap_unit(in_color.h) * 12.f;
+        l_k = l_k >= 12.f ? l_k - 12.f : l_k;
+        const float l_chroma = in_color.s * std::fmin(in_color.l, 1.f - in_color.l);
+        return in_color.l - l_chroma * std::fmax(-1.f, std::fmin(std::fmin(l_k - 3.f, 9.f - l_k), 1.f));
+    }
+}
+
+float atl::srgb_to_linear(float in_value)
+{
+    return in_value <= 0.04045f ? in_value * (1.f / 12.92f) : std::pow((in_value + 0.055f) * (1.f / 1.055f), 2.4f);
+}
+
+float atl::linear_to_srgb(float in_value)
+{
+    return in_value <= 0.0031308f ? in_value * 12.92f : 1.055f * std::pow(in_value, 1.f / 2.4f) - 0.055f;
+}
+
+float atl::srgb_byte_to_linear(uint8_t in_value)
+{
+    return byte_decode_table()[in_value];
+}
+
+void atl::srgb_to_linear(region_type<const color32> in_colors, region_type<color> out_colors)
+{
+    const std::array<float, 256> & l_table = byte_decode_table();
+    const auto l_count = in_colors.size();
+    const color32 * l_in = in_colors.begin();
+    color * l_out = out_colors.begin();
+    for(std::ptrdiff_t i = 0; i < l_count; ++i)
+    {
+        l_out[i].r = l_table[l_in[i].r];
+        l_out[i].g = l_table[l_in[i].g];
+        l_out[i].b = l_table[l_in[i].b];
+        l_out[i].a = float(l_in[i].a) * (1.f / 255.f);
+    }
+}
+
+void atl::linear_to_srgb(region_type<const color> in_colors, region_type<color32> out_colors)
+{
+    const transfer_table_type & l_table = encode_table();
+    const auto l_count = in_colors.size();
+    const color * l_in = in_colors.begin();
+    color32 * l_out = out_colors.begin();
+    for(std::ptrdiff_t i = 0; i < l_count; ++i)
+    {
+        l_out[i].r = color32::to_byte(l_table(l_in[i].r));
+        l_out[i].g = color32::to_byte(l_table(l_in[i].g));
+        l_out[i].b = color32::to_byte(l_table(l_in[i].b));
+        l_out[i].a = color32::to_byte(l_in[i].a);
+    }
+}
+
+void atl::srgb_to_linear(region_type<const color> in_colors, region_type<color> out_colors)
+{
+    const transfer_table_type & l_table = decode_table();
+    const auto l_count = in_colors.size();
+    const color * l_in = in_colors.begin();
+    color * l_out = out_colors.begin();
+    for(std::ptrdiff_t i = 0; i < l_count; ++i)
+    {
+        const float l_alpha = l_in[i].a;
+        l_out[i].r = l_table(l_in[i].r);
+        l_out[i].g = l_table(l_in[i].g);
+        l_out[i].b = l_table(l_in[i].b);
+        l_out[i].a = l_alpha;
+    }
+}
+
+void atl::linear_to_srgb(region_type<const color> in_colors, region_type<color> out_colors)
+{
+    const transfer_table_type & l_table = encode_table();
+    const auto l_count = in_colors.size();
+    const color * l_in = in_colors.begin();
+    color * l_out = out_colors.begin();
+    for(std::ptrdiff_t i = 0; i < l_count; ++i)
+    {
+        const float l_alpha = l_in[i].a;
+        l_out[i].r = l_table(l_in[i].r);
+        l_out[i].g = l_table(l_in[i].g);
+        l_out[i].b = l_table(l_in[i].b);
+        l_out[i].a = l_alpha;
+    }
+}
+
+atl::color_hsv atl::rgb_to_hsv(const color & in_color)
+{
+    const float l_max = std::fmax(in_color.r, std::fmax(in_color.g, in_color.b));
+    const float l_min = std::fmin(in_color.r, std::fmin(in_color.g, in_color.b));
+    const float l_delta = l_max - l_min;
+    return {hue_of(in_color, l_max, l_delta), l_max > 0.f ? l_delta / l_max : 0.f, l_max, in_color.a};
+}
+
+atl::color atl::hsv_to_rgb(const color_hsv & in_color)
+{
+    return color(hsv_channel(in_color, 5.f), hsv_channel(in_color, 3.f), hsv_channel(in_color, 1.f), in_color.a);
+}
+
+atl::color_hsl atl::rgb_to_hsl(const color & in_color)
+{
+    const float l_max = std::fmax(in_color.r, std::fmax(in_color.g, in_color.b));
+    const float l_min = std::fmin(in_color.r, std::fmin(in_color.g, in_color.b));
+    const float l_delta = l_max - l_min;
+    const float l_lightness = (l_max + l_min) * 0.5f;
+    const float l_limit = std::fmin(l_lightness, 1.f - l_lightness);
+    return {hue_of(in_color, l_max, l_delta), l_limit > 0.f ? (l_max - l_lightness) / l_limit : 0.f, l_lightness, in_color.a};
+}
+
+atl::color atl::hsl_to_rgb(const color_hsl & in_color)
+{
+    return color(hsl_channel(in_color, 0.f), hsl_channel(in_color, 8.f), hsl_channel(in_color, 4.f), in_color.a);
+}
+
+void atl::rgb_to_hsv(region_type<const color> in_colors, region_type<color_hsv> out_colors)
+{
+    const auto l_count = in_colors.size();
+    const color * l_in = in_colors.begin();
+    color_hsv * l_out = out_colors.begin();
+    for(std::ptrdiff_t i = 0; i < l_count; ++i)
+        l_out[i] = rgb_to_hsv(l_in[i]);
+}
+
+void atl::hsv_to_rgb(region_type<const color_hsv> in_colors, region_type<color> out_colors)
+{
+    const auto l_count = in_colors.size();
+    const color_hsv * l_in = in_colors.begin();
+    color * l_out = out_colors.begin();
+    for(std::ptrdiff_t i = 0; i < l_count; ++i)
+        l_out[i] = hsv_to_rgb(l_in[i]);
+}
+
+void atl::rgb_to_hsl(region_type<const color> in_colors, region_type<color_hsl> out_colors)
+{
+    const auto l_count = in_colors.size();
+    const color * l_in = in_colors.begin();
+    color_hsl * l_out = out_colors.begin();
+    for(std::ptrdiff_t i = 0; i < l_count; ++i)
+        l_out[i] = rgb_to_hsl(l_in[i]);
+}
+
+void atl::hsl_to_rgb(region_type<const color_hsl> in_colors, region_type<color> out_colors)
+{
+    const auto l_count = in_colors.size();
+    const color_hsl * l_in = in_colors.begin();
+    color * l_out = out_colors.begin();
+    for(std::ptrdiff_t i = 0; i < l_count; ++i)
+        l_out[i] = hsl_to_rgb(l_in[i]);
+}
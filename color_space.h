@@ -0,0 +1,61 @@
+#pragma once
+
+#include "ATLUtil/color.h"
+#include "ATLUtil/region.h"
+
+namespace atl
+{
+    /*
+     * atl
+     * color spaces
+     *
+     * sRGB transfer function conversions and HSV / HSL.
+     *
+     * The exact conversions use powf. The batch versions are table driven:
+     * - decoding sRGB bytes reads a 256 entry table, and is exact.
+     * - other conversions interpolate linearly within 64 buckets per octave of the input, located from its float
+     *   exponent and top mantissa bits. Float results are within 1e-4 relative of the exact curve (3e-5 absolute);
+     *   byte results are within one step of the exactly rounded value, and almost always equal to it.
+     * Alpha is never converted, only copied (and quantized for bytes). Inputs are expected in [0, 1].
+     */
+
+    float srgb_to_linear(float in_value);
+    float linear_to_srgb(float in_value);
+
+    // Exact decode of one sRGB byte, from the 256 entry table.
+    float srgb_byte_to_linear(uint8_t in_value);
+
+    /*
+     Batch sRGB conversions. out must be at least as long as in, and for color to color may be the same array.
+     */
+    void srgb_to_linear(region_type<const color32> in_colors, region_type<color> out_colors);
+    void linear_to_srgb(region_type<const color> in_colors, region_type<color32> out_colors);
+    void srgb_to_linear(region_type<const color> in_colors, region_type<color> out_colors);
+    void linear_to_srgb(region_type<const color> in_colors, region_type<color> out_colors);
+
+    /*
+     color_hsv, color_hsl: Hue is a fraction of a full turn in [0, 1), 0 = red. Saturation, value and lightness are in [0, 1].
+     */
+    struct color_hsv
+    {
+        float h, s, v, a;
+    };
+
+    struct color_hsl
+    {
+        float h, s, l, a;
+    };
+
+    color_hsv rgb_to_hsv(const color & in_color);
+    color hsv_to_rgb(const color_hsv & in_color);
+    color_hsl rgb_to_hsl(const color & in_color);
+    color hsl_to_rgb(const color_hsl & in_color);
+
+    /*
+     Batch HSV / HSL conversions. out must be at least as long as in.
+     */
+    void rgb_to_hsv(region_type<const color> in_colors, region_type<color_hsv> out_colors);
+    void hsv_to_rgb(region_type<const color_hsv> in_colors, region_type<color> out_colors);
+    void rgb_to_hsl(region_type<const color> in_colors, region_type<color_hsl> out_colors);
+    void hsl_to_rgb(region_type<const color_hsl> in_colors, region_type<color> out_colors);
+}
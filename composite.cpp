@@ -0,0 +1,196 @@
+
+#include "composite.h"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    /*
+     Float kernels. Each is one loop over whole pixels, so the four channel operations vectorize together.
+     */
+    void source_over_row(const atl::color_premul * __restrict in_src, atl::color_premul * __restrict io_dst, std::ptrdiff_t in_count)
+    {
+        for(std::ptrdiff_t i = 0; i < in_count; ++i)
+        {
+            const float l_keep = 1.f - in_src[i].a;
+            io_dst[i].r = in_src[i].r + io_dst[i].r * l_keep;
+            io_dst[i].g = in_src[i].g + io_dst[i].g * l_keep;
+            io_dst[i].b = in_src[i].b + io_dst[i].b * l_keep;
+            io_dst[i].a = in_src[i].a + io_dst[i].a * l_keep;
+        }
+    }
+
+    void additive_row(const atl::color_premul * __restrict in_src, atl::color_premul * __restrict io_dst, std::ptrdiff_t in_count)
+    {
+        for(std::ptrdiff_t i = 0; i < in_count; ++i)
+        {
+            io_dst[i].r += in_src[i].r;
+            io_dst[i].g += in_src[i].g;
+            io_dst[i].b += in_src[i].b;
+            io_dst[i].a += in_src[i].a;
+        }
+    }
+
+    void multiply_row(const atl::color_premul * __restrict in_src, atl::color_premul * __restrict io_dst, std::ptrdiff_t in_count)
+    {
+        for(std::ptrdiff_t i = 0; i < in_count; ++i)
+        {
+            const float l_src_keep = 1.f - io_dst[i].a;
+            const float l_dst_keep = 1.f - in_src[i].a;
+            io_dst[i].r = in_src[i].r * io_dst[i].r + in_src[i].r * l_src_keep + io_dst[i].r * l_dst_keep;
+            io_dst[i].g = in_src[i].g * io_dst[i].g + in_src[i].g * l_src_keep + io_dst[i].g * l_dst_keep;
+            io_dst[i].b = in_src[i].b * io_dst[i].b + in_src[i].b * l_src_keep + io_dst[i].b * l_dst_keep;
+            io_dst[i].a = in_src[i].a * io_dst[i].a + in_src[i].a * l_src_keep + io_dst[i].a * l_dst_keep;
+        }
+    }
+
+    void screen_row(const atl::color_premul * __restrict in_src, atl::color_premul * __restrict io_dst, std::ptrdiff_t in_count)
+    {
+        for(std::ptrdiff_t i = 0; i < in_count; ++i)
+        {
+            io_dst[i].r = in_src[i].r + io_dst[i].r - in_src[i].r * io_dst[i].r;
+            io_dst[i].g = in_src[i].g + io_dst[i].g - in_src[i].g * io_dst[i].g;
+            io_dst[i].b = in_src[i].b + io_dst[i].b - in_src[i].b * io_dst[i].b;
+            io_dst[i].a = in_src[i].a + io_dst[i].a - in_src[i].a * io_dst[i].a;
+        }
+    }
+
+    /*
+     Byte kernels work on the flat channel arrays, four channels per pixel.
+     Products are scaled back down with a rounding divide by 255, which compiles to a multiply and shift.
+     */
+    inline uint32_t divide_by_255_rounded(uint32_t in_value)
+    {
+        return (in_value + 127u) / 255u;
+    }
+
+    inline uint8_t saturate_byte(uint32_t in_value)
+    {
+        return uint8_t(in_value < 255u ? in_value : 255u);
+    }
+
+    void source_over_row(const uint8_t * __restrict in_src, uint8_t * __restrict io_dst, std::ptrdiff_t in_channel_count)
+    {
+        for(std::ptrdiff_t p = 0; p < in_channel_count; p += 4)
+        {
+            const uint32_t l_keep = 255u - in_src[p + 3];
+            for(std::ptrdiff_t i = p; i < p + 4; ++i)
+                io_dst[i] = saturate_byte(in_src[i] + divide_by_255_rounded(uint32_t(io_dst[i]) * l_keep));
+        }
+    }
+
+    void additive_row(const uint8_t * __restrict in_src, uint8_t * __restrict io_dst, std::ptrdiff_t in_channel_count)
+    {
+        for(std::ptrdiff_t i = 0; i < in_channel_count; ++i)
+            io_dst[i] = saturate_byte(uint32_t(in_src[i]) + io_dst[i]);
+    }
+
+    void multiply_row(const uint8_t * __restrict in_src, uint8_t * __restrict io_dst, std::ptrdiff_t in_channel_count)
+    {
+        // Alphas are read up front, since the destination alpha is overwritten as the last channel of each pixel.
+        for(std::ptrdiff_t p = 0; p < in_channel_count; p += 4)
+        {
+            const uint32_t l_src_alpha = in_src[p + 3];
+            const uint32_t l_dst_alpha = io_dst[p + 3];
+            for(std::ptrdiff_t i = p; i < p + 4; ++i)
+            {
+                const uint32_t l_src = in_src[i];
+                const uint32_t l_dst = io_dst[i];
+                io_dst[i] = saturate_byte(divide_by_255_rounded(l_src * l_dst + l_src * (255u - l_dst_alpha) + l_dst * (255u - l_src_alpha)));
+            }
+        }
+    }
+
+    void screen_row(const uint8_t * __restrict in_src, uint8_t * __restrict io_dst, std::ptrdiff_t in_channel_count)
+    {
+        for(std::ptrdiff_t i = 0; i < in_channel_count; ++i)
+        {
+            // s + d - s * d / 255, as (s + d) * 255 - s * d over 255 so there is a single rounding:
+            const uint32_t l_src = in_src[i];
+            const uint32_t l_dst = io_dst[i];
+            io_dst[i] = saturate_byte(divide_by_255_rounded((l_src + l_dst) * 255u - l_src * l_dst));
+        }
+    }
+
+    void composite_pixels(atl::blend_mode in_mode, const atl::color_premul * in_src, atl::color_premul * io_dst, std::ptrdiff_t in_count)
+    {
+        switch(in_mode)
+        {
+            case atl::blend_mode::source_over: source_over_row(in_src, io_dst, in_count); break;
+            case atl::blend_mode::additive: additive_row(in_src, io_dst, in_count); break;
+            case atl::blend_mode::multiply: multiply_row(in_src, io_dst, in_count); break;
+            case atl::blend_mode::screen: screen_row(in_src, io_dst, in_count); break;
+        }
+    }
+
+    void composite_pixels(atl::blend_mode in_mode, const atl::color32 * in_src, atl::color32 * io_dst, std::ptrdiff_t in_count)
+    {
+        const uint8_t * l_src = reinterpret_cast<const uint8_t *>(in_src);
+        uint8_t * l_dst = reinterpret_cast<uint8_t *>(io_dst);
+        switch(in_mode)
+        {
+            case atl::blend_mode::source_over: source_over_row(l_src, l_dst, in_count * 4); break;
+            case atl::blend_mode::additive: additive_row(l_src, l_dst, in_count * 4); break;
+            case atl::blend_mode::multiply: multiply_row(l_src, l_dst, in_count * 4); break;
+            case atl::blend_mode::screen: screen_row(l_src, l_dst, in_count * 4); break;
+        }
+    }
+
+    template <typename pixel_type>
+    void composite_surface_bands(atl::blend_mode in_mode,
+                                 const pixel_type * in_src, std::ptrdiff_t in_src_stride,
+                                 pixel_type * io_dst, std::ptrdiff_t in_dst_stride,
+                                 int32_t in_width, int32_t in_height, unsigned in_thread_count)
+    {
+        if(in_width <= 0 || in_height <= 0)
+            return;
+        const int32_t l_band_count = (in_height + atl::composite_band_rows - 1) / atl::composite_band_rows;
+        std::atomic<int32_t> l_next_band(0);
+        auto l_work = [&]()
+        {
+            for(int32_t l_band = l_next_band++; l_band < l_band_count; l_band = l_next_band++)
+            {
+                const int32_t l_row_end = std::min(in_height, (l_band + 1) * atl::composite_band_rows);
+                for(int32_t l_row = l_band * atl::composite_band_rows; l_row < l_row_end; ++l_row)
+                    composite_pixels(in_mode, in_src + l_row * in_src_stride, io_dst + l_row * in_dst_stride, in_width);
+            }
+        };
+
+        const unsigned l_thread_count = unsigned(std::max(1, std::min(int32_t(in_thread_count), l_band_count)));
+        std::vector<std::thread> l_threads;
+        l_threads.reserve(l_thread_count - 1);
+        for(unsigned i = 1; i < l_thread_count; ++i)
+            l_threads.emplace_back(l_work);
+        l_work();
+        for(auto & l_thread : l_threads)
+            l_thread.join();
+    }
+}
+
+void atl::composite_row(blend_mode in_mode, region_type<const color_premul> in_src, region_type<color_premul> io_dst)
+{
+    composite_pixels(in_mode, in_src.begin(), io_dst.begin(), in_src.size());
+}
+
+void atl::composite_row(blend_mode in_mode, region_type<const color32> in_src, region_type<color32> io_dst)
+{
+    composite_pixels(in_mode, in_src.begin(), io_dst.begin(), in_src.size());
+}
+
+void atl::composite_surface(blend_mode in_mode,
+                            const color_premul * in_src, std::ptrdiff_t in_src_stride,
+                            color_premul * io_dst, std::ptrdiff_t in_dst_stride,
+                            int32_t in_width, int32_t in_height, unsigned in_thread_count)
+{
+    composite_surface_bands(in_mode, in_src, in_src_stride, io_dst, in_dst_stride, in_width, in_height, in_thread_count);
+}
+
+void atl::composite_surface(blend_mode in_mode,
+                            const color32 * in_src, std::ptrdiff_t in_src_stride,
+                            color32 * io_dst, std::ptrdiff_t in_dst_stride,
+                            int32_t in_width, int32_t in_height, unsigned in_thread_count)
+{
+    composite_surface_bands(in_mode, in_src, in_src_stride, io_dst, in_dst_stride, in_width, in_height, in_thread_count);
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "ATLUtil/color.h"
+#include "ATLUtil/region.h"
+
+namespace atl
+{
+    /*
+     * atl
+     * compositing
+     *
+     * Porter-Duff style blending of premultiplied colors, src onto dst, written back to dst:
+     *   source_over: src + dst * (1 - src.a)
+     *   additive:    src + dst (clamped to 1 for color32, unclamped in float so HDR values survive)
+     *   multiply:    src * dst + src * (1 - dst.a) + dst * (1 - src.a)
+     *   screen:      src + dst - src * dst
+     * Each formula applies to all four channels, alpha included.
+     *
+     * color32 rows must hold premultiplied bytes; their results are rounded to nearest, exactly as if computed in float.
+     * The row kernels are branch-free loops with the blend mode chosen once per row, so they vectorize.
+     */
+    enum class blend_mode
+    {
+        source_over,
+        additive,
+        multiply,
+        screen
+    };
+
+    /*
+     composite_row: dst must be at least as long as src. src and dst must not overlap, not even exactly.
+     */
+    void composite_row(blend_mode in_mode, region_type<const color_premul> in_src, region_type<color_premul> io_dst);
+    void composite_row(blend_mode in_mode, region_type<const color32> in_src, region_type<color32> io_dst);
+
+    /*
+     composite_surface: Composites a width x height block of pixels. Strides are in pixels, so views into larger
+     surfaces work. The surface is split into bands of composite_band_rows rows that thread_count threads
+     (the calling thread among them) take from a shared counter, so uneven work still balances.
+     src and dst must not overlap.
+     */
+    static const int32_t composite_band_rows = 32;
+
+    void composite_surface(blend_mode in_mode,
+                           const color_premul * in_src, std::ptrdiff_t in_src_stride,
+                           color_premul * io_dst, std::ptrdiff_t in_dst_stride,
+                           int32_t in_width, int32_t in_height, unsigned in_thread_count = 1);
+    void composite_surface(blend_mode in_mode,
+                           const color32 * in_src, std::ptrdiff_t in_src_stride,
+                           color32 * io_dst, std::ptrdiff_t in_dst_stride,
+                           int32_t in_width, int32_t in_height, unsigned in_thread_count = 1);
+}
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "ATLUtil/animation_func.h"
+#include "ATLUtil/basic_math.h"
+#include "ATLUtil/color.h"
+#include "ATLUtil/region.h"
+
+namespace atl
+{
+	/*
+	 color_gradient_type: A keyframe<color> gradient baked to sample_count evenly spaced colors between the first
+	 and last key times, evaluated by table lookup and linear interpolation. As with map_keyframe, times before the
+	 first key give the first color and times after the last give the last.
+
+	 color_type picks the interpolation space:
+	   color:        keys are interpolated as given (straight alpha), as map_keyframe does.
+	   color_premul: keys are premultiplied first, so a fade to transparent does not drag the color of the
+	                 transparent key in with it. Results are premultiplied.
+
+	 Sampling costs the same for any number of keys. Baking is O(keys + sample_count); rebake when keys change.
+	 Between keys the table is exact, so error only appears within a sample of a key whose neighbors have
+	 different slopes; 256 samples is plenty for particle color over life.
+	 */
+	template <typename color_type>
+	struct color_gradient_type
+	{
+		std::vector<color_type> samples;
+		float domain_min = 0.f;
+		float domain_to_index = 0.f;
+
+		/*
+		 bake: keys must be sorted by time and non-empty. sample_count is clamped to at least 2.
+		 */
+		void bake(region_type<const keyframe<color>> in_keys, size_t in_sample_count)
+		{
+			samples.clear();
+			if(in_keys.size() == 0)
+				return;
+			if(in_sample_count < 2)
+				in_sample_count = 2;
+			samples.reserve(in_sample_count);
+
+			const keyframe<color> * keys = in_keys.begin();
+			const keyframe<color> * last_key = in_keys.end() - 1;
+			const float domain_max = last_key->t;
+			domain_min = keys->t;
+			domain_to_index = domain_max > domain_min ? float(in_sample_count - 1) / (domain_max - domain_min) : 0.f;
+			const float step = (domain_max - domain_min) / float(in_sample_count - 1);
+
+			const keyframe<color> * key = keys;
+			for(size_t i = 0; i < in_sample_count; ++i)
+			{
+				const float t = i + 1 == in_sample_count ? domain_max : domain_min + step * float(i);
+				while(key != last_key && !(t < (key + 1)->t))
+					key++;
+				if(key == last_key || (key + 1)->t <= key->t)
+				{
+					samples.push_back(color_type(key->v));
+					continue;
+				}
+				const float fraction = (t - key->t) / ((key + 1)->t - key->t);
+				samples.push_back(interpolate(color_type(key->v), color_type((key + 1)->v), fraction));
+			}
+		}
+
+		bool empty() const { return samples.empty(); }
+
+		/*
+		 sample: The gradient must have been baked from at least one key.
+		 */
+		color_type sample(float t) const
+		{
+			return sample_table(samples.data(), int32_t(samples.size()) - 1, domain_min, domain_to_index, t);
+		}
+
+		/*
+		 Batch sampling, e.g. particle color from normalized age. out_colors must be at least as long as in_times.
+		 The color32 version rounds each channel to bytes (premultiplied bytes for color_premul gradients).
+		 */
+		void sample(region_type<const float> in_times, region_type<color_type> out_colors) const
+		{
+			sample_batch(in_times, out_colors.begin());
+		}
+
+		void sample(region_type<const float> in_times, region_type<color32> out_colors) const
+		{
+			// Sampling straight to bytes makes for one long serial chain per sample; staging short runs of floats
+			// and converting them in bulk with convert_colors is several times faster.
+			color_type chunk[color32_chunk_size];
+			const auto count = in_times.size();
+			for(std::ptrdiff_t i = 0; i < count; i += color32_chunk_size)
+			{
+				const std::ptrdiff_t chunk_count = std::min(count - i, std::ptrdiff_t(color32_chunk_size));
+				sample_batch(region_n(in_times.begin() + i, size_t(chunk_count)), chunk);
+				convert_colors(region_n(static_cast<const color_type *>(chunk), size_t(chunk_count)), region_n(out_colors.begin() + i, size_t(chunk_count)));
+			}
+		}
+
+	private:
+		static const int32_t color32_chunk_size = 64;
+
+		// min / max rather than clamp, and an int32_t index, keep this free of branches on t.
+		// The constant goes first in std::max, which returns it for a NaN t, so NaN samples the first entry.
+		static color_type sample_table(const color_type * table, int32_t last_index, float table_min, float table_to_index, float t)
+		{
+			const float position = std::min(float(last_index), std::max(0.f, (t - table_min) * table_to_index));
+			const int32_t index = std::min(int32_t(position), last_index - 1);
+			return interpolate(table[index], table[index + 1], position - float(index));
+		}
+
+		// The table is read through locals, so stores to out cannot force the members to be reloaded per sample.
+		void sample_batch(region_type<const float> in_times, color_type * __restrict out) const
+		{
+			const color_type * __restrict table = samples.data();
+			const int32_t last_index = int32_t(samples.size()) - 1;
+			const float table_min = domain_min;
+			const float table_to_index = domain_to_index;
+			const auto count = in_times.size();
+			const float * in = in_times.begin();
+			for(std::ptrdiff_t i = 0; i < count; ++i)
+				out[i] = sample_table(table, last_index, table_min, table_to_index, in[i]);
+		}
+
+		static color_type interpolate(const color_type & from, const color_type & to, float fraction)
+		{
+			return color_type(interpf(from.r, to.r, fraction),
+							  interpf(from.g, to.g, fraction),
+							  interpf(from.b, to.b, fraction),
+							  interpf(from.a, to.a, fraction));
+		}
+	};
+
+	template <typename color_type>
+	color_gradient_type<color_type> make_color_gradient(region_type<const keyframe<color>> in_keys, size_t in_sample_count = 256)
+	{
+		color_gradient_type<color_type> result;
+		result.bake(in_keys, in_sample_count);
+		return result;
+	}
+}
@@ -0,0 +1,76 @@
+
+#include "image.h"
+
+namespace
+{
+    /*
+     Box filter rows. Each output pixel averages a 2x2 block, read through one pointer per corner so that every
+     access is a constant stride of two pixels and the loops vectorize. For a source width of 1 the left and right
+     pointers are the same column.
+     */
+    void downsample_row(const uint8_t * __restrict in_top_left, const uint8_t * __restrict in_top_right,
+                        const uint8_t * __restrict in_bottom_left, const uint8_t * __restrict in_bottom_right,
+                        uint8_t * __restrict out_row, std::ptrdiff_t in_count)
+    {
+        for(std::ptrdiff_t p = 0; p < in_count; ++p)
+        {
+            for(std::ptrdiff_t c = 0; c < 4; ++c)
+            {
+                const std::ptrdiff_t i = p * 8 + c;
+                const uint32_t l_sum = uint32_t(in_top_left[i]) + in_top_right[i] + in_bottom_left[i] + in_bottom_right[i];
+                out_row[p * 4 + c] = uint8_t((l_sum + 2u) >> 2);
+            }
+        }
+    }
+
+    void downsample_row(const float * __restrict in_top_left, const float * __restrict in_top_right,
+                        const float * __restrict in_bottom_left, const float * __restrict in_bottom_right,
+                        float * __restrict out_row, std::ptrdiff_t in_count)
+    {
+        for(std::ptrdiff_t p = 0; p < in_count; ++p)
+        {
+            for(std::ptrdiff_t c = 0; c < 4; ++c)
+            {
+                const std::ptrdiff_t i = p * 8 + c;
+                out_row[p * 4 + c] = (in_top_left[i] + in_top_right[i] + in_bottom_left[i] + in_bottom_right[i]) * 0.25f;
+            }
+        }
+    }
+
+    template <typename channel_type, typename pixel_type>
+    void downsample_image(atl::image_view_type<const pixel_type> in_src, atl::image_view_type<pixel_type> out_dst)
+    {
+        const int32_t l_width = std::min(out_dst.width, atl::mip_size(in_src.width));
+        const int32_t l_height = std::min(out_dst.height, atl::mip_size(in_src.height));
+        if(in_src.empty() || l_width <= 0)
+            return;
+        const int32_t l_column_step = in_src.width > 1 ? 1 : 0;
+        const int32_t l_row_step = in_src.height > 1 ? 1 : 0;
+        for(int32_t y = 0; y < l_height; ++y)
+        {
+            const pixel_type * l_top = in_src.row(y * 2);
+            const pixel_type * l_bottom = in_src.row(y * 2 + l_row_step);
+            downsample_row(reinterpret_cast<const channel_type *>(l_top),
+                           reinterpret_cast<const channel_type *>(l_top + l_column_step),
+                           reinterpret_cast<const channel_type *>(l_bottom),
+                           reinterpret_cast<const channel_type *>(l_bottom + l_column_step),
+                           reinterpret_cast<channel_type *>(out_dst.row(y)),
+                           l_width);
+        }
+    }
+}
+
+void atl::downsample_box(image_view_type<const color32> in_src, image_view_type<color32> out_dst)
+{
+    downsample_image<uint8_t>(in_src, out_dst);
+}
+
+void atl::downsample_box(image_view_type<const color> in_src, image_view_type<color> out_dst)
+{
+    downsample_image<float>(in_src, out_dst);
+}
+
+void atl::downsample_box(image_view_type<const color_premul> in_src, image_view_type<color_premul> out_dst)
+{
+    downsample_image<float>(in_src, out_dst);
+}
@@ -0,0 +1,209 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "ATLUtil/color.h"
+#include "ATLUtil/math2d.h"
+#include "ATLUtil/region.h"
+
+namespace atl
+{
+	/*
+	 image_view_type: A width x height block of pixels in some larger allocation, with rows stride pixels apart.
+	 Pixel (x, y) is column x of row y, and row 0 comes first in memory. As a bounds4i, a view covers
+	 l <= x < r and b <= y < t, so bounds() is (height, width, 0, 0). Views do not own their pixels.
+	 Pixels are color32 (RGBA8), color or color_premul.
+	 */
+	template <typename pixel_type>
+	struct image_view_type
+	{
+		pixel_type * pixels = nullptr;
+		std::ptrdiff_t stride = 0;
+		int32_t width = 0;
+		int32_t height = 0;
+
+		image_view_type() {}
+
+		image_view_type(pixel_type * in_pixels, std::ptrdiff_t in_stride, int32_t in_width, int32_t in_height)
+		:
+		pixels(in_pixels),
+		stride(in_stride),
+		width(in_width),
+		height(in_height)
+		{}
+
+		// Mutable views convert to const views.
+		template <typename other_pixel_type>
+		image_view_type(const image_view_type<other_pixel_type> & in_other)
+		:
+		pixels(in_other.pixels),
+		stride(in_other.stride),
+		width(in_other.width),
+		height(in_other.height)
+		{}
+
+		bool empty() const { return width <= 0 || height <= 0; }
+		pixel_type * row(int32_t y) const { return pixels + y * stride; }
+		region_type<pixel_type> row_region(int32_t y) const { return region_n(row(y), width); }
+		pixel_type & at(int32_t x, int32_t y) const { return row(y)[x]; }
+		bounds4i bounds() const { return bounds4i(height, width, 0, 0); }
+
+		/*
+		 sub_view: The part of this view inside in_bounds, which is clipped to bounds(). Coordinates are relative
+		 to this view, so sub views of sub views work as expected.
+		 */
+		image_view_type sub_view(const bounds4i & in_bounds) const
+		{
+			const bounds4i clipped = in_bounds.get_intersection(bounds());
+			if(clipped.width() <= 0 || clipped.height() <= 0)
+				return image_view_type();
+			return image_view_type(row(clipped.b) + clipped.l, stride, clipped.width(), clipped.height());
+		}
+	};
+
+	/*
+	 image_buffer_type: An image that owns its pixels. Each row starts on a row_alignment byte boundary, with
+	 padding after it as needed, so row loops begin on aligned vectors and rows do not share cache lines.
+	 Move-only; copy pixels between images with blit.
+	 */
+	template <typename pixel_type>
+	struct image_buffer_type
+	{
+		static constexpr size_t row_alignment = 64;
+		static_assert(row_alignment % sizeof(pixel_type) == 0, "image pixels must evenly divide the row alignment");
+
+		image_buffer_type() {}
+
+		image_buffer_type(int32_t in_width, int32_t in_height)
+		{
+			resize(in_width, in_height);
+		}
+
+		// A moved-from image is left empty, so a later resize allocates again.
+		image_buffer_type(image_buffer_type && in_other) noexcept
+		:
+		internal_pixels(std::move(in_other.internal_pixels)),
+		internal_byte_count(std::exchange(in_other.internal_byte_count, 0)),
+		internal_view(std::exchange(in_other.internal_view, image_view_type<pixel_type>()))
+		{}
+
+		image_buffer_type & operator=(image_buffer_type && in_other) noexcept
+		{
+			internal_pixels = std::move(in_other.internal_pixels);
+			internal_byte_count = std::exchange(in_other.internal_byte_count, 0);
+			internal_view = std::exchange(in_other.internal_view, image_view_type<pixel_type>());
+			return *this;
+		}
+
+		/*
+		 resize: Pixels are left uninitialized, also when the size does not change.
+		 */
+		void resize(int32_t in_width, int32_t in_height)
+		{
+			const int32_t width = std::max(in_width, 0);
+			const int32_t height = std::max(in_height, 0);
+			const size_t pixels_per_alignment = row_alignment / sizeof(pixel_type);
+			const std::ptrdiff_t stride = std::ptrdiff_t((size_t(width) + pixels_per_alignment - 1) / pixels_per_alignment * pixels_per_alignment);
+			const size_t byte_count = size_t(stride) * size_t(height) * sizeof(pixel_type);
+			if(byte_count != internal_byte_count)
+			{
+				internal_pixels.reset(byte_count > 0 ? static_cast<pixel_type *>(::operator new(byte_count, std::align_val_t(row_alignment))) : nullptr);
+				internal_byte_count = byte_count;
+			}
+			internal_view = image_view_type<pixel_type>(internal_pixels.get(), stride, width, height);
+		}
+
+		int32_t width() const { return internal_view.width; }
+		int32_t height() const { return internal_view.height; }
+		std::ptrdiff_t stride() const { return internal_view.stride; }
+		bool empty() const { return internal_view.empty(); }
+
+		image_view_type<pixel_type> view() { return internal_view; }
+		image_view_type<const pixel_type> view() const { return internal_view; }
+		image_view_type<pixel_type> view(const bounds4i & in_bounds) { return internal_view.sub_view(in_bounds); }
+		image_view_type<const pixel_type> view(const bounds4i & in_bounds) const { return image_view_type<const pixel_type>(internal_view).sub_view(in_bounds); }
+
+	private:
+		struct aligned_delete_type
+		{
+			void operator()(pixel_type * pixels) const { ::operator delete(pixels, std::align_val_t(row_alignment)); }
+		};
+
+		std::unique_ptr<pixel_type, aligned_delete_type> internal_pixels;
+		size_t internal_byte_count = 0;
+		image_view_type<pixel_type> internal_view;
+	};
+
+	/*
+	 blit: Copies src into the top left of dst, one memcpy per row, clipped to the smaller of the two.
+	 The views must not overlap.
+	 */
+	template <typename src_pixel_type>
+	void blit(image_view_type<src_pixel_type> in_src, image_view_type<std::remove_const_t<src_pixel_type>> io_dst)
+	{
+		using pixel_type = std::remove_const_t<src_pixel_type>;
+		const int32_t width = std::min(in_src.width, io_dst.width);
+		const int32_t height = std::min(in_src.height, io_dst.height);
+		if(width <= 0)
+			return;
+		for(int32_t y = 0; y < height; ++y)
+			std::memcpy(io_dst.row(y), in_src.row(y), size_t(width) * sizeof(pixel_type));
+	}
+
+	/*
+	 blit: Copies src to dst with its top left at (x, y) in dst; whatever falls outside dst is clipped.
+	 */
+	template <typename src_pixel_type>
+	void blit(image_view_type<src_pixel_type> in_src, image_view_type<std::remove_const_t<src_pixel_type>> io_dst, int32_t x, int32_t y)
+	{
+		using pixel_type = std::remove_const_t<src_pixel_type>;
+		const image_view_type<pixel_type> target = io_dst.sub_view(bounds4i(y + in_src.height, x + in_src.width, y, x));
+		if(target.empty())
+			return;
+		const image_view_type<const pixel_type> source(in_src.row(std::max(0, -y)) + std::max(0, -x), in_src.stride, target.width, target.height);
+		blit(source, target);
+	}
+
+	template <typename pixel_type>
+	void fill(image_view_type<pixel_type> io_dst, const pixel_type & in_value)
+	{
+		for(int32_t y = 0; y < io_dst.height; ++y)
+			std::fill_n(io_dst.row(y), io_dst.width, in_value);
+	}
+
+	/*
+	 downsample_box: 2x2 box filter from src into dst, whose size should be mip_size of src's. Odd source sizes
+	 drop their last row or column; a source dimension of 1 is kept at 1. Filter premultiplied (and, for color
+	 accuracy, linear) pixels; see color_space.h for sRGB conversions. color32 rounds to nearest.
+	 */
+	void downsample_box(image_view_type<const color32> in_src, image_view_type<color32> out_dst);
+	void downsample_box(image_view_type<const color> in_src, image_view_type<color> out_dst);
+	void downsample_box(image_view_type<const color_premul> in_src, image_view_type<color_premul> out_dst);
+
+	inline int32_t mip_size(int32_t in_size)
+	{
+		return std::max(in_size / 2, 1);
+	}
+
+	/*
+	 generate_mips: Appends the mip chain below src to out_mips, halving each level until 1 x 1.
+	 */
+	template <typename src_pixel_type>
+	void generate_mips(image_view_type<src_pixel_type> in_src, std::vector<image_buffer_type<std::remove_const_t<src_pixel_type>>> & out_mips)
+	{
+		image_view_type<const std::remove_const_t<src_pixel_type>> level = in_src;
+		while(!level.empty() && (level.width > 1 || level.height > 1))
+		{
+			out_mips.emplace_back(mip_size(level.width), mip_size(level.height));
+			downsample_box(level, out_mips.back().view());
+			level = out_mips.back().view();
+		}
+	}
+}
@@ -0,0 +1,289 @@
+#pragma once
+
+#include "ATLUtil/math2d.h"
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include <algorithm>
+
+namespace atl
+{
+	/*
+	 * atl
+	 * interval trees over rangef
+	 *
+	 * Both trees answer overlap queries ("which ranges touch [a, b]") and stabbing queries ("which ranges contain t")
+	 * in O(min(n, (k + 1) log n)) for k matches, not O(log n + k): pruning on each subtree's largest max can still
+	 * walk a path per match. Both use the same inclusive semantics as rangef::overlaps and rangef::contains.
+	 * Matches are reported through a callable taking (const rangef &, const value_type &).
+	 */
+
+	/*
+	 static_interval_tree_type: Built once from a batch of ranges, then queried.
+	 Entries are sorted by min and stored flat; the tree is implicit (node = midpoint of its index span)
+	 and each node carries the largest max in its subtree.
+	 */
+	template <typename value_type>
+	struct static_interval_tree_type
+	{
+		struct entry_type
+		{
+			rangef range;
+			value_type value;
+		};
+
+		std::vector<entry_type> entries;
+		std::vector<float> subtree_max;
+
+		void clear()
+		{
+			entries.clear();
+			subtree_max.clear();
+		}
+
+		void reserve(size_t count) { entries.reserve(count); }
+		void add(const rangef & range, const value_type & value) { entries.push_back({range, value}); }
+
+		// Call after add()ing all entries, and again after any further add()s.
+		void build()
+		{
+			std::sort(entries.begin(), entries.end(), [](const entry_type & a, const entry_type & b) { return a.range.min < b.range.min; });
+			subtree_max.resize(entries.size());
+			build_subtree_max(0, entries.size());
+		}
+
+		size_t size() const { return entries.size(); }
+		bool empty() const { return entries.empty(); }
+
+		template <typename callback_type>
+		void query_overlapping(const rangef & range, callback_type && callback) const
+		{
+			query_subtree(0, entries.size(), range, callback);
+		}
+
+		template <typename callback_type>
+		void query_containing(float value, callback_type && callback) const
+		{
+			query_subtree(0, entries.size(), rangef(value, value), callback);
+		}
+
+	private:
+		float build_subtree_max(size_t lo, size_t hi)
+		{
+			if(lo >= hi) return -std::numeric_limits<float>::max();
+			const size_t mid = lo + (hi - lo) / 2;
+			const float left_max = build_subtree_max(lo, mid);
+			const float right_max = build_subtree_max(mid + 1, hi);
+			subtree_max[mid] = std::max(entries[mid].range.max, std::max(left_max, right_max));
+			return subtree_max[mid];
+		}
+
+		template <typename callback_type>
+		void query_subtree(size_t lo, size_t hi, const rangef & range, callback_type & callback) const
+		{
+			while(lo < hi)
+			{
+				const size_t mid = lo + (hi - lo) / 2;
+				// Nothing below here reaches far enough right:
+				if(subtree_max[mid] < range.min) return;
+				query_subtree(lo, mid, range, callback);
+				const entry_type & entry = entries[mid];
+				// Everything from here on starts too far right:
+				if(entry.range.min > range.max) return;
+				if(entry.range.max >= range.min) callback(entry.range, entry.value);
+				lo = mid + 1;
+			}
+		}
+	};
+
+	/*
+	 interval_tree_type: Supports insert and erase between queries.
+	 A treap ordered by range min, augmented with the subtree max. Nodes live in a pooled vector with a free list,
+	 so steady-state insert/erase does not touch the heap. insert returns a handle that stays valid until erased.
+	 */
+	template <typename value_type>
+	struct interval_tree_type
+	{
+		using handle_type = int32_t;
+		static constexpr handle_type null_handle = -1;
+
+		struct node_type
+		{
+			rangef range;
+			value_type value;
+			float subtree_max;
+			uint32_t priority;
+			handle_type left, right;
+		};
+
+		std::vector<node_type> nodes;
+		std::vector<handle_type> free_nodes;
+		handle_type root = null_handle;
+		size_t count = 0;
+		uint32_t priority_state = 0x9E3779B9u;
+
+		void clear()
+		{
+			nodes.clear();
+			free_nodes.clear();
+			root = null_handle;
+			count = 0;
+		}
+
+		void reserve(size_t capacity) { nodes.reserve(capacity); }
+		size_t size() const { return count; }
+		bool empty() const { return count == 0; }
+
+		const rangef & range(handle_type handle) const { return nodes[handle].range; }
+		value_type & value(handle_type handle) { return nodes[handle].value; }
+		const value_type & value(handle_type handle) const { return nodes[handle].value; }
+
+		handle_type insert(const rangef & range, const value_type & value)
+		{
+			handle_type handle;
+			if(!free_nodes.empty())
+			{
+				handle = free_nodes.back();
+				free_nodes.pop_back();
+			}
+			else
+			{
+				handle = static_cast<handle_type>(nodes.size());
+				nodes.emplace_back();
+			}
+			node_type & node = nodes[handle];
+			node.range = range;
+			node.value = value;
+			node.subtree_max = range.max;
+			node.priority = next_priority();
+			node.left = node.right = null_handle;
+			root = insert_subtree(root, handle);
+			count++;
+			return handle;
+		}
+
+		void erase(handle_type handle)
+		{
+			root = erase_subtree(root, handle);
+			free_nodes.push_back(handle);
+			count--;
+		}
+
+		template <typename callback_type>
+		void query_overlapping(const rangef & range, callback_type && callback) const
+		{
+			query_subtree(root, range, callback);
+		}
+
+		template <typename callback_type>
+		void query_containing(float value, callback_type && callback) const
+		{
+			query_subtree(root, rangef(value, value), callback);
+		}
+
+	private:
+		uint32_t next_priority()
+		{
+			// xorshift32; priorities only need to be well mixed, not secure
+			priority_state ^= priority_state << 13;
+			priority_state ^= priority_state >> 17;
+			priority_state ^= priority_state << 5;
+			return priority_state;
+		}
+
+		// Nodes are ordered by (range.min, handle) so that every key is unique and erase can find its node by descent.
+		bool goes_left_of(handle_type a, handle_type b) const
+		{
+			const float a_min = nodes[a].range.min;
+			const float b_min = nodes[b].range.min;
+			return a_min < b_min || (a_min == b_min && a < b);
+		}
+
+		float subtree_max_of(handle_type handle) const
+		{
+			return handle == null_handle ? -std::numeric_limits<float>::max() : nodes[handle].subtree_max;
+		}
+
+		void update(handle_type handle)
+		{
+			node_type & node = nodes[handle];
+			node.subtree_max = std::max(node.range.max, std::max(subtree_max_of(node.left), subtree_max_of(node.right)));
+		}
+
+		handle_type rotate_right(handle_type handle)
+		{
+			handle_type pivot = nodes[handle].left;
+			nodes[handle].left = nodes[pivot].right;
+			nodes[pivot].right = handle;
+			update(handle);
+			update(pivot);
+			return pivot;
+		}
+
+		handle_type rotate_left(handle_type handle)
+		{
+			handle_type pivot = nodes[handle].right;
+			nodes[handle].right = nodes[pivot].left;
+			nodes[pivot].left = handle;
+			update(handle);
+			update(pivot);
+			return pivot;
+		}
+
+		handle_type insert_subtree(handle_type subtree, handle_type handle)
+		{
+			if(subtree == null_handle) return handle;
+			if(goes_left_of(handle, subtree))
+			{
+				nodes[subtree].left = insert_subtree(nodes[subtree].left, handle);
+				if(nodes[nodes[subtree].left].priority > nodes[subtree].priority) return rotate_right(subtree);
+			}
+			else
+			{
+				nodes[subtree].right = insert_subtree(nodes[subtree].right, handle);
+				if(nodes[nodes[subtree].right].priority > nodes[subtree].priority) return rotate_left(subtree);
+			}
+			update(subtree);
+			return subtree;
+		}
+
+		handle_type merge(handle_type left, handle_type right)
+		{
+			if(left == null_handle) return right;
+			if(right == null_handle) return left;
+			if(nodes[left].priority > nodes[right].priority)
+			{
+				nodes[left].right = merge(nodes[left].right, right);
+				update(left);
+				return left;
+			}
+			nodes[right].left = merge(left, nodes[right].left);
+			update(right);
+			return right;
+		}
+
+		handle_type erase_subtree(handle_type subtree, handle_type handle)
+		{
+			if(subtree == null_handle) return null_handle;
+			if(subtree == handle) return merge(nodes[subtree].left, nodes[subtree].right);
+			if(goes_left_of(handle, subtree)) nodes[subtree].left = erase_subtree(nodes[subtree].left, handle);
+			else nodes[subtree].right = erase_subtree(nodes[subtree].right, handle);
+			update(subtree);
+			return subtree;
+		}
+
+		template <typename callback_type>
+		void query_subtree(handle_type subtree, const rangef & range, callback_type & callback) const
+		{
+			while(subtree != null_handle)
+			{
+				const node_type & node = nodes[subtree];
+				if(node.subtree_max < range.min) return;
+				query_subtree(node.left, range, callback);
+				if(node.range.min > range.max) return;
+				if(node.range.max >= range.min) callback(node.range, node.value);
+				subtree = node.right;
+			}
+		}
+	};
+}
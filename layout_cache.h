@@ -0,0 +1,139 @@
+#pragma once
+
+#include "ATLUtil/math2d.h"
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include <algorithm>
+
+namespace atl
+{
+	/*
+	 layout_cache_type: Retained layout for trees of anchored boxes.
+	 Each node has a size, an anchoring and an offset. Root nodes are placed with box2f(offset, size, anchoring);
+	 child nodes are placed inside their parent's rect with get_sub_bounds_with_size(size, anchoring), then offset.
+
+	 Computed rects are cached. Setters only invalidate a node when a value actually changes, and update()
+	 recomputes the invalidated nodes and their descendants in a single forward pass over flat arrays.
+	 With nothing invalidated, update() is a single branch.
+
+	 Nodes must be added after their parents, which keeps every parent ahead of its children in storage.
+	 */
+	struct layout_cache_type
+	{
+		using node_handle_type = int32_t;
+		static constexpr node_handle_type no_parent = -1;
+
+		node_handle_type add_node(node_handle_type parent, const size2f & size, anchoring anchor, const point2f & offset = point2f(0.f, 0.f))
+		{
+			const auto handle = node_handle_type(internal_parents.size());
+			internal_parents.push_back(parent);
+			internal_sizes.push_back(size);
+			internal_anchorings.push_back(anchor);
+			internal_offsets.push_back(offset);
+			internal_rects.push_back(box2f(0.f, 0.f, 0.f, 0.f));
+			internal_dirty.push_back(1);
+			mark_dirty(handle);
+			return handle;
+		}
+
+		void clear()
+		{
+			internal_parents.clear();
+			internal_sizes.clear();
+			internal_anchorings.clear();
+			internal_offsets.clear();
+			internal_rects.clear();
+			internal_dirty.clear();
+			internal_first_dirty = invalid_first_dirty;
+		}
+
+		void reserve(size_t count)
+		{
+			internal_parents.reserve(count);
+			internal_sizes.reserve(count);
+			internal_anchorings.reserve(count);
+			internal_offsets.reserve(count);
+			internal_rects.reserve(count);
+			internal_dirty.reserve(count);
+		}
+
+		size_t size() const { return internal_parents.size(); }
+
+		void set_size(node_handle_type node, const size2f & size)
+		{
+			if(internal_sizes[node] == size) return;
+			internal_sizes[node] = size;
+			mark_dirty(node);
+		}
+
+		void set_anchoring(node_handle_type node, anchoring anchor)
+		{
+			if(internal_anchorings[node] == anchor) return;
+			internal_anchorings[node] = anchor;
+			mark_dirty(node);
+		}
+
+		void set_offset(node_handle_type node, const point2f & offset)
+		{
+			if(internal_offsets[node] == offset) return;
+			internal_offsets[node] = offset;
+			mark_dirty(node);
+		}
+
+		void invalidate(node_handle_type node) { mark_dirty(node); }
+		void invalidate_all()
+		{
+			if(internal_dirty.empty()) return;
+			std::fill(internal_dirty.begin(), internal_dirty.end(), 1);
+			internal_first_dirty = 0;
+		}
+
+		const size2f & get_size(node_handle_type node) const { return internal_sizes[node]; }
+		anchoring get_anchoring(node_handle_type node) const { return internal_anchorings[node]; }
+		const point2f & get_offset(node_handle_type node) const { return internal_offsets[node]; }
+		node_handle_type get_parent(node_handle_type node) const { return internal_parents[node]; }
+
+		// Rects are only valid after update().
+		const box2f & rect(node_handle_type node) const { return internal_rects[node]; }
+		bool needs_update() const { return internal_first_dirty != invalid_first_dirty; }
+
+		// Returns true if any rect was recomputed.
+		bool update()
+		{
+			if(!needs_update()) return false;
+			const auto count = node_handle_type(internal_parents.size());
+			for(node_handle_type i = internal_first_dirty; i < count; ++i)
+			{
+				const auto parent = internal_parents[i];
+				// A node is recomputed if it changed or if its parent was recomputed during this pass.
+				if(parent != no_parent) internal_dirty[i] |= internal_dirty[parent];
+				if(!internal_dirty[i]) continue;
+				box2f result = parent == no_parent ?
+					box2f(internal_offsets[i], internal_sizes[i], internal_anchorings[i]) :
+					internal_rects[parent].get_sub_bounds_with_size(internal_sizes[i], internal_anchorings[i]) + internal_offsets[i];
+				internal_rects[i] = result;
+			}
+			std::fill(internal_dirty.begin() + internal_first_dirty, internal_dirty.end(), 0);
+			internal_first_dirty = invalid_first_dirty;
+			return true;
+		}
+
+	private:
+		static constexpr node_handle_type invalid_first_dirty = std::numeric_limits<node_handle_type>::max();
+
+		void mark_dirty(node_handle_type node)
+		{
+			internal_dirty[node] = 1;
+			internal_first_dirty = std::min(internal_first_dirty, node);
+		}
+
+		std::vector<node_handle_type> internal_parents;
+		std::vector<size2f> internal_sizes;
+		std::vector<anchoring> internal_anchorings;
+		std::vector<point2f> internal_offsets;
+		std::vector<box2f> internal_rects;
+		std::vector<uint8_t> internal_dirty;
+		node_handle_type internal_first_dirty = invalid_first_dirty;
+	};
+}
@@ -10,3 +10,127 @@ const atl::rangef atl::rangef::Max(-std::numeric_limits<float>::max(), std::nume
 const atl::rangef atl::rangef::InvertedMax(std::numeric_limits<float>::max(), -std::numeric_limits<float>::max());
 const atl::box2f atl::box2f::MaxInvertedBounds(atl::rangef::InvertedMax, atl::rangef::InvertedMax);
 const atl::box2f atl::box2f::MaxBounds(atl::rangef::Max, atl::rangef::Max);
+
+namespace
+{
+    inline float turn_direction(const atl::point2f & in_origin, const atl::point2f & in_a, const atl::point2f & in_b)
+    {
+        return (in_a - in_origin).cross(in_b - in_origin);
+    }
+
+    // Clip against a single half plane, keeping points where (point.*axis - boundary) * sign >= 0.
+    // Stops writing at out_end, so a clip that runs out of room is truncated rather than overrunning.
+    template <float atl::point2f::* axis>
+    atl::point2f * clip_polygon_to_half_plane(const atl::point2f * in_begin, const atl::point2f * in_end, float in_boundary, float in_sign, atl::point2f * out_begin, atl::point2f * out_end)
+    {
+        auto l_out = out_begin;
+        if(in_begin == in_end)
+            return l_out;
+        auto l_prev = in_end - 1;
+        float l_prev_distance = ((*l_prev).*axis - in_boundary) * in_sign;
+        for(auto l_itr = in_begin; l_itr != in_end; l_prev = l_itr++)
+        {
+            float l_distance = ((*l_itr).*axis - in_boundary) * in_sign;
+            if((l_distance >= 0.f) != (l_prev_distance >= 0.f) && l_out != out_end)
+            {
+                float l_t = l_prev_distance / (l_prev_distance - l_distance);
+                *l_out++ = atl::point2f(*l_prev).interpolate(*l_itr, l_t);
+            }
+            if(l_distance >= 0.f && l_out != out_end)
+                *l_out++ = *l_itr;
+            l_prev_distance = l_distance;
+        }
+        return l_out;
+    }
+}
+
+atl::region_type<atl::point2f> atl::convex_hull(region_type<point2f> points, region_type<point2f> hull_storage)
+{
+    std::sort(points.begin(), points.end(), [](const point2f & a, const point2f & b) {
+        return a.x < b.x || (a.x == b.x && a.y < b.y);
+    });
+    return convex_hull_of_sorted_points(points, hull_storage);
+}
+
+atl::region_type<atl::point2f> atl::convex_hull_of_sorted_points(region_type<const point2f> points, region_type<point2f> hull_storage)
+{
+    auto l_count = points.size();
+    if(l_count < 3)
+        return {hull_storage.begin(), std::copy(points.begin(), points.end(), hull_storage.begin())};
+    
+    auto l_points = points.begin();
+    auto l_hull = hull_storage.begin();
+    std::ptrdiff_t k = 0;
+    
+    // Lower chain:
+    for(std::ptrdiff_t i = 0; i < l_count; ++i)
+    {
+        while(k >= 2 && turn_direction(l_hull[k - 2], l_hull[k - 1], l_points[i]) <= 0.f)
+            k--;
+        l_hull[k++] = l_points[i];
+    }
+    
+    // Upper chain, walking back from the second-to-last point:
+    const auto l_lower_count = k + 1;
+    for(std::ptrdiff_t i = l_count - 2; i >= 0; --i)
+    {
+        while(k >= l_lower_count && turn_direction(l_hull[k - 2], l_hull[k - 1], l_points[i]) <= 0.f)
+            k--;
+        l_hull[k++] = l_points[i];
+    }
+    
+    // The last point written is the first point again.
+    return {l_hull, l_hull + k - 1};
+}
+
+atl::region_type<atl::point2f> atl::clip_polygon_to_box(region_type<const point2f> polygon, const box2f & box, region_type<point2f> output_storage, region_type<point2f> scratch_storage)
+{
+    auto l_scratch = scratch_storage.begin();
+    auto l_scratch_end = scratch_storage.end();
+    auto l_output = output_storage.begin();
+    auto l_output_end = output_storage.end();
+    
+    // Ping-pong between the two buffers so the final pass lands in output_storage:
+    auto l_end = clip_polygon_to_half_plane<&point2f::x>(polygon.begin(), polygon.end(), box.l, 1.f, l_scratch, l_scratch_end);
+    l_end = clip_polygon_to_half_plane<&point2f::x>(l_scratch, l_end, box.r, -1.f, l_output, l_output_end);
+    l_end = clip_polygon_to_half_plane<&point2f::y>(l_output, l_end, box.b, 1.f, l_scratch, l_scratch_end);
+    l_end = clip_polygon_to_half_plane<&point2f::y>(l_scratch, l_end, box.t, -1.f, l_output, l_output_end);
+    return {l_output, l_end};
+}
+
+bool atl::convex_polygon_contains(region_type<const point2f> polygon, const point2f & point)
+{
+    if(polygon.empty())
+        return false;
+    auto l_prev = polygon.back();
+    for(auto l_itr = polygon.begin(); l_itr != polygon.end(); l_prev = l_itr++)
+    {
+        if(turn_direction(*l_prev, *l_itr, point) < 0.f)
+            return false;
+    }
+    return true;
+}
+
+void atl::convex_polygon_contains_points(region_type<const point2f> polygon, region_type<const point2f> points, region_type<bool> results)
+{
+    const auto l_count = points.size();
+    auto l_points = points.begin();
+    auto l_results = results.begin();
+    bool l_any_edges = !polygon.empty();
+    for(std::ptrdiff_t i = 0; i < l_count; ++i)
+        l_results[i] = l_any_edges;
+    if(!l_any_edges)
+        return;
+    
+    auto l_prev = polygon.back();
+    for(auto l_itr = polygon.begin(); l_itr != polygon.end(); l_prev = l_itr++)
+    {
+        const point2f l_origin = *l_prev;
+        const point2f l_edge = *l_itr - *l_prev;
+        for(std::ptrdiff_t i = 0; i < l_count; ++i)
+        {
+            float l_side = l_edge.x * (l_points[i].y - l_origin.y) - l_edge.y * (l_points[i].x - l_origin.x);
+            l_results[i] = l_results[i] & (l_side >= 0.f);
+        }
+    }
+}
@@ -4,6 +4,7 @@
 
 #include "basic_math.h"
 #include "math2d_fwd.h"
+#include "region.h"
 #include <cmath>
 #include <algorithm>
 #include <array>
@@ -204,6 +205,10 @@ namespace atl
             return dot(*this);
         }
         
+        float cross(const point2f & in_otherPoint) const {
+            return x * in_otherPoint.y - y * in_otherPoint.x;
+        }
+        
         float manhattan_distance(const point2f & in_otherPoint) const {
             return std::abs(x - in_otherPoint.x) + std::abs(y - in_otherPoint.y);
         }
@@ -1020,4 +1025,47 @@ namespace atl
 		point.x = atl::clamp(point.x, box.l, box.r);
 		point.y = atl::clamp(point.y, box.b, box.t);
 	}
+
+	/*
+	 * polygon functions
+	 * Polygons are runs of point2f with counter-clockwise winding and an implicit closing edge.
+	 * Nothing here allocates; results are written into caller-provided regions and the written
+	 * sub-region is returned.
+	 */
+
+	/*
+	 convex_hull: Andrew's monotone chain. Sorts points in place, then writes the hull (counter-clockwise,
+	 starting from the lowest-x point, no repeated closing point) into hull_storage.
+	 hull_storage must have room for points.size() + 1 entries.
+	 */
+	region_type<point2f> convex_hull(region_type<point2f> points, region_type<point2f> hull_storage);
+
+	/*
+	 convex_hull_of_sorted_points: As convex_hull, but points must already be sorted by x, then y.
+	 */
+	region_type<point2f> convex_hull_of_sorted_points(region_type<const point2f> points, region_type<point2f> hull_storage);
+
+	/*
+	 clip_polygon_to_box: Sutherland-Hodgman clip of polygon against box.
+	 output_storage and scratch_storage must each have room for polygon.size() + 4 entries if polygon is convex.
+	 A concave polygon needs 6 * polygon.size(): each of the four passes keeps the vertices inside its edge and adds
+	 one per edge that crosses it, and as each crossing edge has an inside end, that is at most 3/2 as many vertices
+	 as the pass was given ((3/2)^4 < 6). Writes stop at the end of each storage region, so storage below these
+	 bounds gives a truncated, wrong polygon rather than an overrun.
+	 Returns a region of output_storage, empty if the polygon lies entirely outside the box.
+	 */
+	region_type<point2f> clip_polygon_to_box(region_type<const point2f> polygon, const box2f & box, region_type<point2f> output_storage, region_type<point2f> scratch_storage);
+
+	/*
+	 convex_polygon_contains: Test a single point against a counter-clockwise convex polygon.
+	 Points on an edge count as inside.
+	 */
+	bool convex_polygon_contains(region_type<const point2f> polygon, const point2f & point);
+
+	/*
+	 convex_polygon_contains_points: Batched version of convex_polygon_contains.
+	 Iterates edge-major so the inner loop over points is branch-free and vectorizes.
+	 results must be at least as long as points.
+	 */
+	void convex_polygon_contains_points(region_type<const point2f> polygon, region_type<const point2f> points, region_type<bool> results);
 }
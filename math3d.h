@@ -870,7 +870,7 @@ namespace atl
             float lAngleSweep = acosf(lDot) * in_t;
             
             quatf v2 = in_dest_quat - *this * lDot;
-            v2.getUnitQuaternion();
+            v2 = v2.getUnitQuaternion();
             
             return *this * cosf(lAngleSweep) + v2*sinf(lAngleSweep);
         }
@@ -0,0 +1,308 @@
+#include "noise.h"
+#include "math2d.h"
+#include "math3d.h"
+
+namespace
+{
+    // Integer hash with good avalanche (lowbias32); multiplies and shifts only, so it vectorizes.
+    inline uint32_t mix_bits(uint32_t h)
+    {
+        h ^= h >> 16;
+        h *= 0x7feb352du;
+        h ^= h >> 15;
+        h *= 0x846ca68bu;
+        h ^= h >> 16;
+        return h;
+    }
+
+    inline uint32_t seed_bits(uint32_t in_seed)
+    {
+        return mix_bits(in_seed * 0x9e3779b9u + 0x632be5abu);
+    }
+
+    inline uint32_t hash_lattice(uint32_t in_seed_bits, int32_t x)
+    {
+        return mix_bits(in_seed_bits ^ (uint32_t(x) * 0x8da6b343u));
+    }
+
+    inline uint32_t hash_lattice(uint32_t in_seed_bits, int32_t x, int32_t y)
+    {
+        return mix_bits(in_seed_bits ^ (uint32_t(x) * 0x8da6b343u) ^ (uint32_t(y) * 0xd8163841u));
+    }
+
+    inline uint32_t hash_lattice(uint32_t in_seed_bits, int32_t x, int32_t y, int32_t z)
+    {
+        return mix_bits(in_seed_bits ^ (uint32_t(x) * 0x8da6b343u) ^ (uint32_t(y) * 0xd8163841u) ^ (uint32_t(z) * 0xcb1ab31fu));
+    }
+
+    // Top bits of h as a float in [-1, 1).
+    inline float signed_unit(uint32_t h)
+    {
+        return float(int32_t(h)) * (1.f / 2147483648.f);
+    }
+
+    // floor without a libm call or a select, which keeps the batch loops vectorizable. Valid for |x| < 2^31.
+    inline int32_t floor_to_int(float x)
+    {
+        const int32_t l_truncated = int32_t(x);
+        return l_truncated - int32_t(x < float(l_truncated));
+    }
+
+    // Quintic fade: zero first and second derivatives at 0 and 1.
+    inline float fade(float t)
+    {
+        return t * t * t * (t * (t * 6.f - 15.f) + 10.f);
+    }
+
+    inline float lerp(float a, float b, float t)
+    {
+        return a + (b - a) * t;
+    }
+
+    inline float value_noise_1d(uint32_t in_seed_bits, float x)
+    {
+        const int32_t l_x = floor_to_int(x);
+        const float l_fx = float(l_x);
+        return lerp(signed_unit(hash_lattice(in_seed_bits, l_x)),
+                    signed_unit(hash_lattice(in_seed_bits, l_x + 1)),
+                    fade(x - l_fx));
+    }
+
+    inline float value_noise_2d(uint32_t in_seed_bits, float x, float y)
+    {
+        const int32_t l_x = floor_to_int(x), l_y = floor_to_int(y);
+        const float l_fx = float(l_x), l_fy = float(l_y);
+        const float l_u = fade(x - l_fx), l_v = fade(y - l_fy);
+        const float l_bottom = lerp(signed_unit(hash_lattice(in_seed_bits, l_x, l_y)), signed_unit(hash_lattice(in_seed_bits, l_x + 1, l_y)), l_u);
+        const float l_top = lerp(signed_unit(hash_lattice(in_seed_bits, l_x, l_y + 1)), signed_unit(hash_lattice(in_seed_bits, l_x + 1, l_y + 1)), l_u);
+        return lerp(l_bottom, l_top, l_v);
+    }
+
+    inline float value_noise_3d(uint32_t in_seed_bits, float x, float y, float z)
+    {
+        const int32_t l_x = floor_to_int(x), l_y = floor_to_int(y), l_z = floor_to_int(z);
+        const float l_fx = float(l_x), l_fy = float(l_y), l_fz = float(l_z);
+        const float l_u = fade(x - l_fx), l_v = fade(y - l_fy), l_w = fade(z - l_fz);
+        auto l_plane = [&](int32_t in_z) {
+            const float l_bottom = lerp(signed_unit(hash_lattice(in_seed_bits, l_x, l_y, in_z)), signed_unit(hash_lattice(in_seed_bits, l_x + 1, l_y, in_z)), l_u);
+            const float l_top = lerp(signed_unit(hash_lattice(in_seed_bits, l_x, l_y + 1, in_z)), signed_unit(hash_lattice(in_seed_bits, l_x + 1, l_y + 1, in_z)), l_u);
+            return lerp(l_bottom, l_top, l_v);
+        };
+        return lerp(l_plane(l_z), l_plane(l_z + 1), l_w);
+    }
+
+    /*
+     Gradients have each component drawn from [-1, 1] (different bits of the same hash), so every corner
+     contribution is bounded by 1 per dimension and the results can be scaled into [-1, 1] exactly.
+     */
+    inline float gradient_dot(uint32_t h, float dx)
+    {
+        return signed_unit(h) * dx;
+    }
+
+    inline float gradient_dot(uint32_t h, float dx, float dy)
+    {
+        return signed_unit(h) * dx + signed_unit(h << 16) * dy;
+    }
+
+    inline float gradient_dot(uint32_t h, float dx, float dy, float dz)
+    {
+        return signed_unit(h) * dx + signed_unit(h << 11) * dy + signed_unit(h << 22) * dz;
+    }
+
+    inline float gradient_noise_1d(uint32_t in_seed_bits, float x)
+    {
+        const int32_t l_x = floor_to_int(x);
+        const float l_fx = float(l_x);
+        const float l_dx = x - l_fx;
+        // Largest possible magnitude is 0.5, at the cell center:
+        return 2.f * lerp(gradient_dot(hash_lattice(in_seed_bits, l_x), l_dx),
+                          gradient_dot(hash_lattice(in_seed_bits, l_x + 1), l_dx - 1.f),
+                          fade(l_dx));
+    }
+
+    inline float gradient_noise_2d(uint32_t in_seed_bits, float x, float y)
+    {
+        const int32_t l_x = floor_to_int(x), l_y = floor_to_int(y);
+        const float l_fx = float(l_x), l_fy = float(l_y);
+        const float l_dx = x - l_fx, l_dy = y - l_fy;
+        const float l_u = fade(l_dx), l_v = fade(l_dy);
+        const float l_bottom = lerp(gradient_dot(hash_lattice(in_seed_bits, l_x, l_y), l_dx, l_dy),
+                                    gradient_dot(hash_lattice(in_seed_bits, l_x + 1, l_y), l_dx - 1.f, l_dy), l_u);
+        const float l_top = lerp(gradient_dot(hash_lattice(in_seed_bits, l_x, l_y + 1), l_dx, l_dy - 1.f),
+                                 gradient_dot(hash_lattice(in_seed_bits, l_x + 1, l_y + 1), l_dx - 1.f, l_dy - 1.f), l_u);
+        return lerp(l_bottom, l_top, l_v);
+    }
+
+    inline float gradient_noise_3d(uint32_t in_seed_bits, float x, float y, float z)
+    {
+        const int32_t l_x = floor_to_int(x), l_y = floor_to_int(y), l_z = floor_to_int(z);
+        const float l_fx = float(l_x), l_fy = float(l_y), l_fz = float(l_z);
+        const float l_dx = x - l_fx, l_dy = y - l_fy, l_dz = z - l_fz;
+        const float l_u = fade(l_dx), l_v = fade(l_dy), l_w = fade(l_dz);
+        auto l_plane = [&](int32_t in_z, float in_dz) {
+            const float l_bottom = lerp(gradient_dot(hash_lattice(in_seed_bits, l_x, l_y, in_z), l_dx, l_dy, in_dz),
+                                        gradient_dot(hash_lattice(in_seed_bits, l_x + 1, l_y, in_z), l_dx - 1.f, l_dy, in_dz), l_u);
+            const float l_top = lerp(gradient_dot(hash_lattice(in_seed_bits, l_x, l_y + 1, in_z), l_dx, l_dy - 1.f, in_dz),
+                                     gradient_dot(hash_lattice(in_seed_bits, l_x + 1, l_y + 1, in_z), l_dx - 1.f, l_dy - 1.f, in_dz), l_u);
+            return lerp(l_bottom, l_top, l_v);
+        };
+        // Largest possible magnitude is 1.5, at the cell center:
+        return (2.f / 3.f) * lerp(l_plane(l_z, l_dz), l_plane(l_z + 1, l_dz - 1.f), l_w);
+    }
+
+    inline float fractal_gradient_noise_3d(uint32_t in_seed, float x, float y, float z, int in_octaves, float in_lacunarity, float in_gain)
+    {
+        float l_sum = 0.f, l_amplitude = 1.f, l_total_amplitude = 0.f, l_frequency = 1.f;
+        for(int i = 0; i < in_octaves; ++i)
+        {
+            // A different seed per octave keeps lattice points of successive octaves from lining up.
+            l_sum += l_amplitude * gradient_noise_3d(seed_bits(in_seed + uint32_t(i)), x * l_frequency, y * l_frequency, z * l_frequency);
+            l_total_amplitude += l_amplitude;
+            l_amplitude *= in_gain;
+            l_frequency *= in_lacunarity;
+        }
+        return l_total_amplitude > 0.f ? l_sum / l_total_amplitude : 0.f;
+    }
+
+    inline atl::point2f shake_offset(uint32_t in_seed, float in_magnitude, float in_time)
+    {
+        // Two independent channels per seed:
+        return atl::point2f(in_magnitude * gradient_noise_1d(seed_bits(in_seed * 2u), in_time),
+                            in_magnitude * gradient_noise_1d(seed_bits(in_seed * 2u + 1u), in_time));
+    }
+}
+
+float atl::value_noise(uint32_t in_seed, float in_x)
+{
+    return value_noise_1d(seed_bits(in_seed), in_x);
+}
+
+float atl::value_noise(uint32_t in_seed, float in_x, float in_y)
+{
+    return value_noise_2d(seed_bits(in_seed), in_x, in_y);
+}
+
+float atl::value_noise(uint32_t in_seed, float in_x, float in_y, float in_z)
+{
+    return value_noise_3d(seed_bits(in_seed), in_x, in_y, in_z);
+}
+
+float atl::gradient_noise(uint32_t in_seed, float in_x)
+{
+    return gradient_noise_1d(seed_bits(in_seed), in_x);
+}
+
+float atl::gradient_noise(uint32_t in_seed, float in_x, float in_y)
+{
+    return gradient_noise_2d(seed_bits(in_seed), in_x, in_y);
+}
+
+float atl::gradient_noise(uint32_t in_seed, float in_x, float in_y, float in_z)
+{
+    return gradient_noise_3d(seed_bits(in_seed), in_x, in_y, in_z);
+}
+
+void atl::value_noise(uint32_t in_seed, region_type<const float> in_positions, region_type<float> out_values)
+{
+    const uint32_t l_seed_bits = seed_bits(in_seed);
+    const auto l_count = in_positions.size();
+    const float * l_in = in_positions.begin();
+    float * l_out = out_values.begin();
+    for(std::ptrdiff_t i = 0; i < l_count; ++i)
+        l_out[i] = value_noise_1d(l_seed_bits, l_in[i]);
+}
+
+void atl::value_noise(uint32_t in_seed, region_type<const point2f> in_positions, region_type<float> out_values)
+{
+    const uint32_t l_seed_bits = seed_bits(in_seed);
+    const auto l_count = in_positions.size();
+    const point2f * l_in = in_positions.begin();
+    float * l_out = out_values.begin();
+    for(std::ptrdiff_t i = 0; i < l_count; ++i)
+        l_out[i] = value_noise_2d(l_seed_bits, l_in[i].x, l_in[i].y);
+}
+
+void atl::value_noise(uint32_t in_seed, region_type<const point3f> in_positions, region_type<float> out_values)
+{
+    const uint32_t l_seed_bits = seed_bits(in_seed);
+    const auto l_count = in_positions.size();
+    const point3f * l_in = in_positions.begin();
+    float * l_out = out_values.begin();
+    for(std::ptrdiff_t i = 0; i < l_count; ++i)
+        l_out[i] = value_noise_3d(l_seed_bits, l_in[i].x, l_in[i].y, l_in[i].z);
+}
+
+void atl::gradient_noise(uint32_t in_seed, region_type<const float> in_positions, region_type<float> out_values)
+{
+    const uint32_t l_seed_bits = seed_bits(in_seed);
+    const auto l_count = in_positions.size();
+    const float * l_in = in_positions.begin();
+    float * l_out = out_values.begin();
+    for(std::ptrdiff_t i = 0; i < l_count; ++i)
+        l_out[i] = gradient_noise_1d(l_seed_bits, l_in[i]);
+}
+
+void atl::gradient_noise(uint32_t in_seed, region_type<const point2f> in_positions, region_type<float> out_values)
+{
+    const uint32_t l_seed_bits = seed_bits(in_seed);
+    const auto l_count = in_positions.size();
+    const point2f * l_in = in_positions.begin();
+    float * l_out = out_values.begin();
+    for(std::ptrdiff_t i = 0; i < l_count; ++i)
+        l_out[i] = gradient_noise_2d(l_seed_bits, l_in[i].x, l_in[i].y);
+}
+
+void atl::gradient_noise(uint32_t in_seed, region_type<const point3f> in_positions, region_type<float> out_values)
+{
+    const uint32_t l_seed_bits = seed_bits(in_seed);
+    const auto l_count = in_positions.size();
+    const point3f * l_in = in_positions.begin();
+    float * l_out = out_values.begin();
+    for(std::ptrdiff_t i = 0; i < l_count; ++i)
+        l_out[i] = gradient_noise_3d(l_seed_bits, l_in[i].x, l_in[i].y, l_in[i].z);
+}
+
+float atl::fractal_gradient_noise(uint32_t in_seed, float in_x, float in_y, float in_z, int in_octaves, float in_lacunarity, float in_gain)
+{
+    return fractal_gradient_noise_3d(in_seed, in_x, in_y, in_z, in_octaves, in_lacunarity, in_gain);
+}
+
+void atl::fractal_gradient_noise(uint32_t in_seed, region_type<const point3f> in_positions, region_type<float> out_values, int in_octaves, float in_lacunarity, float in_gain)
+{
+    const auto l_count = in_positions.size();
+    const point3f * l_in = in_positions.begin();
+    float * l_out = out_values.begin();
+    for(std::ptrdiff_t i = 0; i < l_count; ++i)
+        l_out[i] = 0.f;
+    // Octave by octave, so that the inner loop is a single noise evaluation per element:
+    float l_amplitude = 1.f, l_total_amplitude = 0.f, l_frequency = 1.f;
+    for(int o = 0; o < in_octaves; ++o)
+    {
+        const uint32_t l_seed_bits = seed_bits(in_seed + uint32_t(o));
+        for(std::ptrdiff_t i = 0; i < l_count; ++i)
+            l_out[i] += l_amplitude * gradient_noise_3d(l_seed_bits, l_in[i].x * l_frequency, l_in[i].y * l_frequency, l_in[i].z * l_frequency);
+        l_total_amplitude += l_amplitude;
+        l_amplitude *= in_gain;
+        l_frequency *= in_lacunarity;
+    }
+    if(l_total_amplitude <= 0.f)
+        return;
+    const float l_scale = 1.f / l_total_amplitude;
+    for(std::ptrdiff_t i = 0; i < l_count; ++i)
+        l_out[i] *= l_scale;
+}
+
+atl::point2f atl::noise_shake(uint32_t in_seed, float in_magnitude, float in_time)
+{
+    return shake_offset(in_seed, in_magnitude, in_time);
+}
+
+void atl::noise_shake(uint32_t in_seed, float in_magnitude, region_type<const float> in_times, region_type<point2f> out_offsets)
+{
+    const auto l_count = in_times.size();
+    const float * l_in = in_times.begin();
+    point2f * l_out = out_offsets.begin();
+    for(std::ptrdiff_t i = 0; i < l_count; ++i)
+        l_out[i] = shake_offset(in_seed + uint32_t(i), in_magnitude, l_in[i]);
+}
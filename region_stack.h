@@ -26,6 +26,14 @@ namespace atl
 
 		region_value_type & push() { return *internal_stack_head++; }
 		void pop() { internal_stack_head--; }
+		region_type<region_value_type> push(size_t count)
+		{
+			region_value_type * pushed = internal_stack_head;
+			internal_stack_head += count;
+			return {pushed, internal_stack_head};
+		}
+		void pop(size_t count) { internal_stack_head -= count; }
+		void clear() { internal_stack_head = internal_storage.begin(); }
 		region_value_type * begin() const { return internal_storage.begin(); }
 		region_value_type * end() const { return internal_stack_head; }
 		region_value_type & bottom() const { return *internal_storage.begin(); }
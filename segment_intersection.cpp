@@ -0,0 +1,137 @@
+
+#include "segment_intersection.h"
+
+bool atl::segment_intersection(const segment2f & first, const segment2f & second, point2f & out_point)
+{
+    const point2f l_first_delta = first.b - first.a;
+    const point2f l_second_delta = second.b - second.a;
+    const float l_denominator = l_first_delta.cross(l_second_delta);
+    if(l_denominator == 0.f)
+        return false;
+
+    const point2f l_offset = second.a - first.a;
+    const float l_first_t = l_offset.cross(l_second_delta) / l_denominator;
+    const float l_second_t = l_offset.cross(l_first_delta) / l_denominator;
+    if(l_first_t < 0.f || l_first_t > 1.f || l_second_t < 0.f || l_second_t > 1.f)
+        return false;
+
+    out_point = first.a + l_first_delta * l_first_t;
+    return true;
+}
+
+void atl::find_segment_intersections_brute_force(region_type<const segment2f> segments, bool ignore_shared_endpoints, std::vector<segment_intersection_type> & results)
+{
+    const auto l_count = segments.size();
+    const auto l_segments = segments.begin();
+    point2f l_point;
+    for(std::ptrdiff_t i = 0; i < l_count; ++i)
+    {
+        for(std::ptrdiff_t j = i + 1; j < l_count; ++j)
+        {
+            if(ignore_shared_endpoints && segments_share_endpoint(l_segments[i], l_segments[j]))
+                continue;
+            if(segment_intersection(l_segments[i], l_segments[j], l_point))
+                results.push_back({uint32_t(i), uint32_t(j), l_point});
+        }
+    }
+}
+
+int32_t atl::segment_intersection_grid_type::cell_x(float x) const
+{
+    return atl::clamp(int32_t((x - internal_bounds.l) * internal_inverse_cell_w), int32_t{0}, internal_cells_x - 1);
+}
+
+int32_t atl::segment_intersection_grid_type::cell_y(float y) const
+{
+    return atl::clamp(int32_t((y - internal_bounds.b) * internal_inverse_cell_h), int32_t{0}, internal_cells_y - 1);
+}
+
+atl::segment_intersection_grid_type::cell_range_type atl::segment_intersection_grid_type::cell_range_for(const segment2f & segment) const
+{
+    return {
+        cell_x(std::min(segment.a.x, segment.b.x)),
+        cell_y(std::min(segment.a.y, segment.b.y)),
+        cell_x(std::max(segment.a.x, segment.b.x)),
+        cell_y(std::max(segment.a.y, segment.b.y))
+    };
+}
+
+void atl::segment_intersection_grid_type::find_intersections(region_type<const segment2f> segments, bool ignore_shared_endpoints, std::vector<segment_intersection_type> & results)
+{
+    const auto l_count = segments.size();
+    const auto l_segments = segments.begin();
+    if(l_count < 2)
+        return;
+
+    // Size the grid so that cells are roughly square and hold segments_per_cell segments on average:
+    internal_bounds = box2f::MaxInvertedBounds;
+    for(std::ptrdiff_t i = 0; i < l_count; ++i)
+    {
+        internal_bounds.include(l_segments[i].a);
+        internal_bounds.include(l_segments[i].b);
+    }
+    const float l_width = std::max(internal_bounds.width(), std::numeric_limits<float>::min());
+    const float l_height = std::max(internal_bounds.height(), std::numeric_limits<float>::min());
+    const float l_target_cells = std::max(1.f, float(l_count) / segments_per_cell);
+    const float l_cell_size = std::max(std::sqrt(l_width * l_height / l_target_cells), std::max(l_width, l_height) / float(max_cells_per_axis));
+    internal_cells_x = atl::clamp(int32_t(l_width / l_cell_size), int32_t{1}, max_cells_per_axis);
+    internal_cells_y = atl::clamp(int32_t(l_height / l_cell_size), int32_t{1}, max_cells_per_axis);
+    internal_inverse_cell_w = float(internal_cells_x) / l_width;
+    internal_inverse_cell_h = float(internal_cells_y) / l_height;
+
+    // Counting sort of segment indices into cells:
+    const size_t l_num_cells = size_t(internal_cells_x) * size_t(internal_cells_y);
+    internal_cell_starts.assign(l_num_cells + 1, 0);
+    for(std::ptrdiff_t i = 0; i < l_count; ++i)
+    {
+        const auto l_range = cell_range_for(l_segments[i]);
+        for(int32_t y = l_range.y0; y <= l_range.y1; ++y)
+            for(int32_t x = l_range.x0; x <= l_range.x1; ++x)
+                internal_cell_starts[size_t(y) * internal_cells_x + x + 1]++;
+    }
+    for(size_t c = 0; c < l_num_cells; ++c)
+        internal_cell_starts[c + 1] += internal_cell_starts[c];
+    internal_cell_entries.resize(internal_cell_starts[l_num_cells]);
+    for(std::ptrdiff_t i = 0; i < l_count; ++i)
+    {
+        const auto l_range = cell_range_for(l_segments[i]);
+        for(int32_t y = l_range.y0; y <= l_range.y1; ++y)
+            for(int32_t x = l_range.x0; x <= l_range.x1; ++x)
+                internal_cell_entries[internal_cell_starts[size_t(y) * internal_cells_x + x]++] = uint32_t(i);
+    }
+    // The fill pass advanced each start to the next cell's start; shift back.
+    for(size_t c = l_num_cells; c > 0; --c)
+        internal_cell_starts[c] = internal_cell_starts[c - 1];
+    internal_cell_starts[0] = 0;
+
+    // Test pairs within each cell. Entries were added in index order, so i < j holds for every pair below.
+    point2f l_point;
+    for(int32_t y = 0; y < internal_cells_y; ++y)
+    {
+        for(int32_t x = 0; x < internal_cells_x; ++x)
+        {
+            const size_t l_cell = size_t(y) * internal_cells_x + x;
+            const uint32_t * l_begin = internal_cell_entries.data() + internal_cell_starts[l_cell];
+            const uint32_t * l_end = internal_cell_entries.data() + internal_cell_starts[l_cell + 1];
+            for(auto l_first = l_begin; l_first != l_end; ++l_first)
+            {
+                const segment2f & l_first_segment = l_segments[*l_first];
+                for(auto l_second = l_first + 1; l_second != l_end; ++l_second)
+                {
+                    const segment2f & l_second_segment = l_segments[*l_second];
+                    if(ignore_shared_endpoints && segments_share_endpoint(l_first_segment, l_second_segment))
+                        continue;
+                    if(!segment_intersection(l_first_segment, l_second_segment, l_point))
+                        continue;
+                    // Only the cell owning the crossing reports it. Clamp into both bounding boxes first so
+                    // rounding cannot push the point into a cell that one of the segments was not added to.
+                    box2f l_overlap = box2f({l_first_segment.a, l_first_segment.b}).get_intersection(box2f({l_second_segment.a, l_second_segment.b}));
+                    point2f l_owner_point = l_point;
+                    clamp_point_to_box(l_owner_point, l_overlap);
+                    if(cell_x(l_owner_point.x) == x && cell_y(l_owner_point.y) == y)
+                        results.push_back({*l_first, *l_second, l_point});
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "ATLUtil/math2d.h"
+#include "ATLUtil/region.h"
+#include <cstdint>
+#include <vector>
+
+namespace atl
+{
+	struct segment2f
+	{
+		point2f a, b;
+	};
+
+	struct segment_intersection_type
+	{
+		uint32_t first_segment;
+		uint32_t second_segment;
+		point2f point;
+	};
+
+	/*
+	 segment_intersection: Returns true and writes the crossing point if the two closed segments meet at a single point.
+	 Parallel and collinear segments are reported as not intersecting.
+	 */
+	bool segment_intersection(const segment2f & first, const segment2f & second, point2f & out_point);
+
+	/*
+	 segments_share_endpoint: True if the segments have an endpoint in common, as consecutive polyline segments do.
+	 */
+	inline bool segments_share_endpoint(const segment2f & first, const segment2f & second)
+	{
+		return first.a == second.a || first.a == second.b || first.b == second.a || first.b == second.b;
+	}
+
+	/*
+	 find_segment_intersections_brute_force: Tests every pair, O(n^2). Reference implementation for find_segment_intersections.
+	 Appends to results, with first_segment < second_segment.
+	 */
+	void find_segment_intersections_brute_force(region_type<const segment2f> segments, bool ignore_shared_endpoints, std::vector<segment_intersection_type> & results);
+
+	/*
+	 segment_intersection_grid_type: Finds all crossings in a set of segments using a uniform grid.
+	 Segments are bucketed by the cells their bounding boxes cover, and each pair is only tested within shared cells.
+	 A crossing is reported only by the cell containing it, so no pair is reported twice.
+	 The grid keeps its buffers between calls, so repeated queries of similar size do not allocate.
+	 Results match find_segment_intersections_brute_force, though not necessarily in the same order.
+	 */
+	struct segment_intersection_grid_type
+	{
+		// Target average number of segments per cell; the grid is sized from the segment count.
+		float segments_per_cell = 2.f;
+		// Upper bound on the number of cells along each axis.
+		int32_t max_cells_per_axis = 1024;
+
+		void find_intersections(region_type<const segment2f> segments, bool ignore_shared_endpoints, std::vector<segment_intersection_type> & results);
+
+	private:
+		struct cell_range_type
+		{
+			int32_t x0, y0, x1, y1;
+		};
+
+		int32_t cell_x(float x) const;
+		int32_t cell_y(float y) const;
+		cell_range_type cell_range_for(const segment2f & segment) const;
+
+		box2f internal_bounds;
+		float internal_inverse_cell_w;
+		float internal_inverse_cell_h;
+		int32_t internal_cells_x;
+		int32_t internal_cells_y;
+		std::vector<uint32_t> internal_cell_starts;
+		std::vector<uint32_t> internal_cell_entries;
+	};
+}
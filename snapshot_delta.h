@@ -0,0 +1,258 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+#include "ATLUtil/bit_string.h"
+#include "ATLUtil/debug_break.h"
+#include "ATLUtil/region.h"
+
+namespace atl
+{
+    /*
+     * atl
+     * snapshot delta compression
+     *
+     * Sends a snapshot as its difference from a baseline that the receiver already has, IE the last snapshot it
+     * acknowledged. Snapshots are plain byte images of game state (usually a struct or an array of them), described
+     * by a list of fields. A field that is byte-for-byte the same as in the baseline costs at most one bit.
+     *
+     * Fields are grouped in blocks of 32, and blocks in groups of 64. Each group is written as:
+     * - a mask with a bit per block, set for the blocks in which any field changed, then for each changed block:
+     * - a mask with a bit per field in the block, set for the fields that changed, then
+     * - the new value of each changed field, in order.
+     * So static state costs one bit per 32 fields, and a group of clean blocks is a single write.
+     *
+     * Fields must be listed in increasing offset order and must not overlap.
+     *
+     * Choosing and tracking baselines is up to the caller. Both ends must use the same baseline bytes and the same
+     * fields. To send the first snapshot, or after losing track of the baseline, use a zeroed one.
+     */
+    enum class snapshot_field_encoding : uint8_t
+    {
+        // The field's new bytes.
+        raw,
+        // An integer of 1, 2, 4 or 8 bytes, written as its change from the baseline: the wrapped difference,
+        // zigzag coded, as an Elias gamma code. Small steps (counters, quantized positions, health) take a few bits.
+        integer_delta
+    };
+
+    struct snapshot_field_type
+    {
+        uint32_t offset;
+        uint32_t size;
+        snapshot_field_encoding encoding;
+    };
+
+    /*
+     snapshot_repeat_fields: Appends element_fields once per element of an array of count elements, each
+     element_size bytes after the last, starting at offset. Describe an entity struct once (with offsetof and
+     sizeof) and repeat it for the entity array.
+     */
+    inline void snapshot_repeat_fields(std::vector<snapshot_field_type>& fields, region_type<const snapshot_field_type> element_fields,
+                                       uint32_t offset, uint32_t element_size, uint32_t count)
+    {
+        fields.reserve(fields.size() + size_t(element_fields.size()) * count);
+        for(uint32_t element = 0; element < count; ++element)
+            for(const snapshot_field_type& field : element_fields)
+                fields.push_back({offset + element * element_size + field.offset, field.size, field.encoding});
+    }
+
+    // True if each field starts at or after the end of the one before it, as the delta writer requires.
+    inline bool snapshot_fields_ordered(region_type<const snapshot_field_type> fields)
+    {
+        uint64_t end = 0;
+        for(const snapshot_field_type& field : fields)
+        {
+            if(field.offset < end) return false;
+            end = uint64_t(field.offset) + field.size;
+        }
+        return true;
+    }
+
+    static const uint32_t snapshot_block_fields = 32;
+    static const uint32_t snapshot_group_blocks = 64;
+
+    // Loads an integer field of 1, 2, 4 or 8 bytes, zero extended.
+    inline uint64_t snapshot_load_integer(const bit_string_byte_type* bytes, uint32_t size)
+    {
+        switch(size)
+        {
+        case 1: return bytes[0];
+        case 2: { uint16_t value; std::memcpy(&value, bytes, 2); return value; }
+        case 4: { uint32_t value; std::memcpy(&value, bytes, 4); return value; }
+        default: { uint64_t value; std::memcpy(&value, bytes, 8); return value; }
+        }
+    }
+
+    inline void snapshot_store_integer(bit_string_byte_type* bytes, uint32_t size, uint64_t value)
+    {
+        switch(size)
+        {
+        case 1: bytes[0] = bit_string_byte_type(value); break;
+        case 2: { const uint16_t narrow = uint16_t(value); std::memcpy(bytes, &narrow, 2); break; }
+        case 4: { const uint32_t narrow = uint32_t(value); std::memcpy(bytes, &narrow, 4); break; }
+        default: std::memcpy(bytes, &value, 8); break;
+        }
+    }
+
+    inline bool snapshot_is_integer_field(const snapshot_field_type& field)
+    {
+        return field.encoding == snapshot_field_encoding::integer_delta && (field.size == 1 || field.size == 2 || field.size == 4 || field.size == 8);
+    }
+
+    // Fields of 1, 2, 4 or 8 bytes compare as one integer rather than through a memcmp call.
+    inline bool snapshot_field_changed(const snapshot_field_type& field, const bit_string_byte_type* baseline, const bit_string_byte_type* snapshot)
+    {
+        const bit_string_byte_type* a = baseline + field.offset;
+        const bit_string_byte_type* b = snapshot + field.offset;
+        switch(field.size)
+        {
+        case 1:
+        case 2:
+        case 4:
+        case 8: return snapshot_load_integer(a, field.size) != snapshot_load_integer(b, field.size);
+        default: return std::memcmp(a, b, field.size) != 0;
+        }
+    }
+
+    /*
+     snapshot_changed_fields: A mask of the fields (up to 32) that differ. Most blocks of mostly static state are
+     clean, and their fields usually sit together (an entity or two), so one memcmp over the bytes from the first
+     field to the end of the last settles them. Padding in between can only send a clean block down the per field
+     path, which is exact.
+     */
+    inline uint32_t snapshot_changed_fields(const snapshot_field_type* block, uint32_t count, const bit_string_byte_type* baseline, const bit_string_byte_type* snapshot)
+    {
+        const uint32_t span_begin = block[0].offset;
+        const uint32_t span_end = block[count - 1].offset + block[count - 1].size;
+        if(std::memcmp(baseline + span_begin, snapshot + span_begin, span_end - span_begin) == 0)
+            return 0;
+        uint32_t changed = 0;
+        for(uint32_t i = 0; i < count; ++i)
+            changed |= uint32_t(snapshot_field_changed(block[i], baseline, snapshot)) << i;
+        return changed;
+    }
+
+    /*
+     bit_string_write_snapshot_delta: Writes the fields of snapshot that differ from baseline. Both point at
+     snapshot images that hold every field. Fails, writing nothing, if the fields are out of order or overlap.
+     */
+    template <typename output_backing_buffer_type>
+    bool bit_string_write_snapshot_delta(bit_string_buffer_wrapper_type<output_backing_buffer_type>& output_buffer, region_type<const snapshot_field_type> fields,
+                                         const bit_string_byte_type* baseline, const bit_string_byte_type* snapshot)
+    {
+        // Out of order fields would give snapshot_changed_fields a negative span, and it would read past the snapshots.
+        const bool ordered = snapshot_fields_ordered(fields);
+        atl_fatal_assert(ordered, "bit_string_write_snapshot_delta: fields must be in increasing offset order and must not overlap");
+        if(!ordered) return false;
+        const snapshot_field_type* all_fields = fields.begin();
+        const uint32_t field_count = uint32_t(fields.size());
+        const uint32_t block_count = (field_count + snapshot_block_fields - 1) / snapshot_block_fields;
+        for(uint32_t first_block = 0; first_block < block_count; first_block += snapshot_group_blocks)
+        {
+            const uint32_t group_blocks = std::min(snapshot_group_blocks, block_count - first_block);
+            uint32_t changed_fields[snapshot_group_blocks];
+            uint64_t changed_blocks = 0;
+            for(uint32_t b = 0; b < group_blocks; ++b)
+            {
+                const uint32_t first = (first_block + b) * snapshot_block_fields;
+                changed_fields[b] = snapshot_changed_fields(all_fields + first, std::min(snapshot_block_fields, field_count - first), baseline, snapshot);
+                changed_blocks |= uint64_t(changed_fields[b] != 0) << b;
+            }
+
+            if(!bit_string_write_bits(output_buffer, changed_blocks, group_blocks)) return false;
+            for(; changed_blocks != 0; changed_blocks &= changed_blocks - 1)
+            {
+                const uint32_t b = bit_string_lowest_set_bit(changed_blocks);
+                const uint32_t first = (first_block + b) * snapshot_block_fields;
+                const snapshot_field_type* block = all_fields + first;
+                uint32_t changed = changed_fields[b];
+                if(!bit_string_write_bits(output_buffer, changed, std::min(snapshot_block_fields, field_count - first))) return false;
+                for(; changed != 0; changed &= changed - 1)
+                {
+                    const snapshot_field_type& field = block[bit_string_lowest_set_bit(changed)];
+                    if(snapshot_is_integer_field(field))
+                    {
+                        // The difference wraps at the field's width, then is sign extended so that small steps either way stay small.
+                        const unsigned shift = 64 - field.size * 8;
+                        const uint64_t difference = snapshot_load_integer(snapshot + field.offset, field.size) - snapshot_load_integer(baseline + field.offset, field.size);
+                        const int64_t signed_difference = int64_t(difference << shift) >> shift;
+                        if(!bit_string_write_elias_gamma(output_buffer, signed_difference)) return false;
+                    }
+                    else
+                    {
+                        auto input_buffer = bit_string_wrap_backing_buffer(simple_backing_buffer(const_cast<bit_string_byte_type*>(snapshot) + field.offset, field.size));
+                        if(!bit_string_copy_bytes(input_buffer, output_buffer, field.size)) return false;
+                    }
+                }
+            }
+        }
+        return true;
+    }
+
+    /*
+     bit_string_read_snapshot_delta: Rebuilds the snapshot from baseline and the delta. snapshot may be baseline
+     itself, to apply the delta in place; otherwise baseline is copied into it first. Bytes outside the fields are
+     copied from baseline. On failure snapshot is left partly updated.
+     */
+    template <typename input_backing_buffer_type>
+    bool bit_string_read_snapshot_delta(bit_string_buffer_wrapper_type<input_backing_buffer_type>& input_buffer, region_type<const snapshot_field_type> fields,
+                                        const bit_string_byte_type* baseline, bit_string_byte_type* snapshot, size_t snapshot_size)
+    {
+        if(snapshot != baseline)
+            std::memcpy(snapshot, baseline, snapshot_size);
+        const snapshot_field_type* all_fields = fields.begin();
+        const uint32_t field_count = uint32_t(fields.size());
+        const uint32_t block_count = (field_count + snapshot_block_fields - 1) / snapshot_block_fields;
+        for(uint32_t first_block = 0; first_block < block_count; first_block += snapshot_group_blocks)
+        {
+            uint64_t changed_blocks;
+            if(!bit_string_read_bits(input_buffer, changed_blocks, std::min(snapshot_group_blocks, block_count - first_block))) return false;
+            for(; changed_blocks != 0; changed_blocks &= changed_blocks - 1)
+            {
+                const uint32_t first = (first_block + bit_string_lowest_set_bit(changed_blocks)) * snapshot_block_fields;
+                const snapshot_field_type* block = all_fields + first;
+                uint32_t changed;
+                if(!bit_string_read_bits(input_buffer, changed, std::min(snapshot_block_fields, field_count - first))) return false;
+                for(; changed != 0; changed &= changed - 1)
+                {
+                    const snapshot_field_type& field = block[bit_string_lowest_set_bit(changed)];
+                    if(snapshot_is_integer_field(field))
+                    {
+                        int64_t difference;
+                        if(!bit_string_read_elias_gamma(input_buffer, difference)) return false;
+                        snapshot_store_integer(snapshot + field.offset, field.size, snapshot_load_integer(snapshot + field.offset, field.size) + uint64_t(difference));
+                    }
+                    else
+                    {
+                        auto output_buffer = bit_string_wrap_backing_buffer(simple_backing_buffer(snapshot + field.offset, field.size));
+                        if(!bit_string_copy_bytes(input_buffer, output_buffer, field.size)) return false;
+                    }
+                }
+            }
+        }
+        return true;
+    }
+
+    /*
+     Typed versions for a snapshot that is a single trivially copyable struct.
+     */
+    template <typename snapshot_type, typename output_backing_buffer_type>
+    bool bit_string_write_snapshot_delta(bit_string_buffer_wrapper_type<output_backing_buffer_type>& output_buffer, region_type<const snapshot_field_type> fields,
+                                         const snapshot_type& baseline, const snapshot_type& snapshot)
+    {
+        static_assert(std::is_trivially_copyable<snapshot_type>::value, "bit_string_write_snapshot_delta: snapshots must be trivially copyable");
+        return bit_string_write_snapshot_delta(output_buffer, fields, reinterpret_cast<const bit_string_byte_type*>(&baseline), reinterpret_cast<const bit_string_byte_type*>(&snapshot));
+    }
+
+    template <typename snapshot_type, typename input_backing_buffer_type>
+    bool bit_string_read_snapshot_delta(bit_string_buffer_wrapper_type<input_backing_buffer_type>& input_buffer, region_type<const snapshot_field_type> fields,
+                                        const snapshot_type& baseline, snapshot_type& snapshot)
+    {
+        static_assert(std::is_trivially_copyable<snapshot_type>::value, "bit_string_read_snapshot_delta: snapshots must be trivially copyable");
+        return bit_string_read_snapshot_delta(input_buffer, fields, reinterpret_cast<const bit_string_byte_type*>(&baseline), reinterpret_cast<bit_string_byte_type*>(&snapshot), sizeof(snapshot_type));
+    }
+}
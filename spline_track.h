@@ -0,0 +1,245 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include <algorithm>
+#include "ATLUtil/animation_func.h"
+#include "ATLUtil/region.h"
+
+namespace atl
+{
+    /*
+     * atl
+     * cubic spline tracks
+     *
+     * Smooth alternatives to the linear keyframe_track. Keys are converted up front into one cubic per segment,
+     * stored as polynomial coefficients in the segment's local parameter u in [0, 1], so a sample is a search for
+     * the segment plus three multiply-adds per component.
+     *
+     * Works with any value type that supports value + value, value - value and value * float:
+     * float, point2f, point3f and color all qualify.
+     * As with keyframe_track, values are held before the first key and after the last.
+     */
+
+    /*
+     hermite_key: A value and its rate of change (per unit time) at time t.
+     */
+    template <typename KeyframeType>
+    struct hermite_key
+    {
+        float t;
+        KeyframeType v;
+        KeyframeType tangent;
+    };
+
+    /*
+     bezier_key: A value and the control points on either side of it. Segment i is the cubic Bezier curve
+     v[i], out_control[i], in_control[i + 1], v[i + 1], with its parameter running linearly in time.
+     */
+    template <typename KeyframeType>
+    struct bezier_key
+    {
+        float t;
+        KeyframeType v;
+        KeyframeType in_control;
+        KeyframeType out_control;
+    };
+
+    template <typename KeyframeType>
+    class spline_track
+    {
+    public:
+        struct segment_coefficients
+        {
+            // value(u) = ((a * u + b) * u + c) * u + d
+            KeyframeType a, b, c, d;
+        };
+
+        // Segment start times are kept apart from the coefficients so that the search only walks floats.
+        std::vector<float> segment_times;
+        std::vector<float> segment_inverse_durations;
+        std::vector<segment_coefficients> segments;
+
+        bool empty() const { return segments.empty(); }
+        size_t size() const { return segments.size(); }
+
+        void clear()
+        {
+            segment_times.clear();
+            segment_inverse_durations.clear();
+            segments.clear();
+        }
+
+        /*
+         build_hermite: Keys must be sorted by time.
+         */
+        void build_hermite(region_type<const hermite_key<KeyframeType>> in_keys)
+        {
+            clear();
+            const auto l_count = size_t(in_keys.size());
+            const hermite_key<KeyframeType> * l_keys = in_keys.begin();
+            if(l_count == 1)
+                add_constant_segment(l_keys[0].t, l_keys[0].v);
+            for(size_t i = 0; i + 1 < l_count; ++i)
+                add_hermite_segment(l_keys[i].t, l_keys[i + 1].t, l_keys[i].v, l_keys[i + 1].v, l_keys[i].tangent, l_keys[i + 1].tangent);
+        }
+
+        /*
+         build_catmull_rom: Passes through every key, with tangents taken from the neighbouring keys
+         ((v[i + 1] - v[i - 1]) / (t[i + 1] - t[i - 1]), one-sided at the ends), so uneven key spacing is handled.
+         Where both neighbours share a time (coincident keys at an end) the tangent is flat. Keys must be sorted by time.
+         */
+        void build_catmull_rom(region_type<const keyframe<KeyframeType>> in_keys)
+        {
+            clear();
+            const auto l_count = size_t(in_keys.size());
+            const keyframe<KeyframeType> * l_keys = in_keys.begin();
+            if(l_count == 1)
+                add_constant_segment(l_keys[0].t, l_keys[0].v);
+            if(l_count < 2)
+                return;
+            auto l_tangent = [&](size_t i) {
+                const size_t l_prev = i > 0 ? i - 1 : i;
+                const size_t l_next = i + 1 < l_count ? i + 1 : i;
+                const KeyframeType l_change = l_keys[l_next].v - l_keys[l_prev].v;
+                const float l_duration = l_keys[l_next].t - l_keys[l_prev].t;
+                return l_duration > 0.f ? l_change * (1.f / l_duration) : l_change - l_change;
+            };
+            KeyframeType l_tangent_begin = l_tangent(0);
+            for(size_t i = 0; i + 1 < l_count; ++i)
+            {
+                KeyframeType l_tangent_end = l_tangent(i + 1);
+                add_hermite_segment(l_keys[i].t, l_keys[i + 1].t, l_keys[i].v, l_keys[i + 1].v, l_tangent_begin, l_tangent_end);
+                l_tangent_begin = l_tangent_end;
+            }
+        }
+
+        /*
+         build_bezier: Keys must be sorted by time.
+         */
+        void build_bezier(region_type<const bezier_key<KeyframeType>> in_keys)
+        {
+            clear();
+            const auto l_count = size_t(in_keys.size());
+            const bezier_key<KeyframeType> * l_keys = in_keys.begin();
+            if(l_count == 1)
+                add_constant_segment(l_keys[0].t, l_keys[0].v);
+            for(size_t i = 0; i + 1 < l_count; ++i)
+            {
+                const KeyframeType & p0 = l_keys[i].v;
+                const KeyframeType & p1 = l_keys[i].out_control;
+                const KeyframeType & p2 = l_keys[i + 1].in_control;
+                const KeyframeType & p3 = l_keys[i + 1].v;
+                add_segment(l_keys[i].t, l_keys[i + 1].t, {
+                    (p1 - p2) * 3.f + p3 - p0,
+                    (p0 + p2) * 3.f - p1 * 6.f,
+                    (p1 - p0) * 3.f,
+                    p0
+                });
+            }
+        }
+
+        /*
+         find_segment: Index of the segment containing in_t, clamped to the first and last segments. O(log N).
+         */
+        size_t find_segment(float in_t) const
+        {
+            auto l_itr = std::upper_bound(segment_times.begin(), segment_times.end(), in_t);
+            return l_itr == segment_times.begin() ? 0 : size_t(l_itr - segment_times.begin()) - 1;
+        }
+
+        /*
+         sample: Random access, O(log N). The track must not be empty.
+         */
+        KeyframeType sample(float in_t) const
+        {
+            return sample_segment(in_t, find_segment(in_t));
+        }
+
+        /*
+         sample: Cursor-assisted access, amortized O(1) for steadily advancing time; see keyframe_cursor.
+         */
+        KeyframeType sample(float in_t, keyframe_cursor & io_cursor) const
+        {
+            const size_t l_count = segment_times.size();
+            size_t l_index = io_cursor.index;
+            if(l_index >= l_count || in_t < segment_times[l_index])
+                l_index = find_segment(in_t);
+            else
+            {
+                while(l_index + 1 < l_count && !(in_t < segment_times[l_index + 1]))
+                    l_index++;
+            }
+            io_cursor.index = l_index;
+            return sample_segment(in_t, l_index);
+        }
+
+        /*
+         sample: Batch evaluation of one track over ascending times (any order works, ascending is fastest).
+         out_values must be at least as long as in_times.
+         */
+        void sample(region_type<const float> in_times, region_type<KeyframeType> out_values) const
+        {
+            keyframe_cursor l_cursor;
+            auto l_out = out_values.begin();
+            for(float l_t : in_times)
+                *l_out++ = sample(l_t, l_cursor);
+        }
+
+    private:
+        KeyframeType sample_segment(float in_t, size_t in_index) const
+        {
+            const float l_u = clamp((in_t - segment_times[in_index]) * segment_inverse_durations[in_index], 0.f, 1.f);
+            const segment_coefficients & l_segment = segments[in_index];
+            return ((l_segment.a * l_u + l_segment.b) * l_u + l_segment.c) * l_u + l_segment.d;
+        }
+
+        void add_segment(float in_begin, float in_end, const segment_coefficients & in_coefficients)
+        {
+            segment_times.push_back(in_begin);
+            // Coincident keys give a zero-length segment, which acts as a step.
+            segment_inverse_durations.push_back(in_end > in_begin ? 1.f / (in_end - in_begin) : 0.f);
+            segments.push_back(in_coefficients);
+            if(!(in_end > in_begin))
+            {
+                // With zero duration u would stay 0, so hold the end value instead.
+                const KeyframeType l_end = in_coefficients.a + in_coefficients.b + in_coefficients.c + in_coefficients.d;
+                const KeyframeType l_zero = l_end - l_end;
+                segments.back() = {l_zero, l_zero, l_zero, l_end};
+            }
+        }
+
+        void add_constant_segment(float in_t, const KeyframeType & in_v)
+        {
+            const KeyframeType l_zero = in_v - in_v;
+            add_segment(in_t, in_t, {l_zero, l_zero, l_zero, in_v});
+        }
+
+        void add_hermite_segment(float in_begin, float in_end, const KeyframeType & p0, const KeyframeType & p1, const KeyframeType & m0, const KeyframeType & m1)
+        {
+            // Tangents are per unit time; the cubic is in u, so scale them by the segment duration.
+            const float l_duration = in_end - in_begin;
+            const KeyframeType l_m0 = m0 * l_duration;
+            const KeyframeType l_m1 = m1 * l_duration;
+            add_segment(in_begin, in_end, {
+                (p0 - p1) * 2.f + l_m0 + l_m1,
+                (p1 - p0) * 3.f - l_m0 * 2.f - l_m1,
+                l_m0,
+                p0
+            });
+        }
+    };
+
+    /*
+     sample_spline_tracks: Sample many tracks at the same time value, advancing one cursor per track.
+     cursors and out_values must be at least as long as tracks.
+     */
+    template <typename KeyframeType>
+    void sample_spline_tracks(float in_t, region_type<const spline_track<KeyframeType>> in_tracks, region_type<keyframe_cursor> io_cursors, region_type<KeyframeType> out_values)
+    {
+        auto l_cursor = io_cursors.begin();
+        auto l_out = out_values.begin();
+        for(const auto & l_track : in_tracks)
+            *l_out++ = l_track.sample(in_t, *l_cursor++);
+    }
+}
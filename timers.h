@@ -5,7 +5,9 @@
 #include "array_util.h"
 #include "basic_math.h"
 #include <cmath>
+#include <cstdint>
 #include <vector>
+#include <algorithm>
 #include <initializer_list>
 
 namespace atl
@@ -186,4 +188,140 @@ namespace atl
             return in_array[to_int((int)c_array_len(in_array))];
         }
     };
+    
+    /*
+     timer_pool
+     Many timers stored as structure-of-arrays: values, reciprocal durations and loop flags.
+     tick() moves every timer in one branch-free pass, then
+     reports timers that finished or looped during that pass as index lists, so nothing needs to
+     poll done() per timer.
+     One-shot timers behave like atl::timer::tick, looping timers like atl::timer::tick_and_loop;
+     a looping timer that wraps more than once in a single tick is reported once.
+     Timer indices stay valid until remove()d, after which add() may reuse them.
+     */
+    class timer_pool
+    {
+    private:
+        std::vector<float> _values;
+        std::vector<float> _rates;
+        std::vector<uint32_t> _loops;
+        std::vector<uint32_t> _events;
+        std::vector<uint32_t> _free;
+        std::vector<uint32_t> _finished;
+        std::vector<uint32_t> _looped;
+        
+        enum : uint32_t { event_finished = 1, event_looped = 2 };
+        
+    public:
+        void reserve(size_t in_count)
+        {
+            _values.reserve(in_count);
+            _rates.reserve(in_count);
+            _loops.reserve(in_count);
+            _events.reserve(in_count);
+        }
+        
+        // Adds a timer that is not running (done), like a default constructed atl::timer.
+        uint32_t add(float in_duration, bool in_looping = false)
+        {
+            uint32_t l_index;
+            if(!_free.empty())
+            {
+                l_index = _free.back();
+                _free.pop_back();
+            }
+            else
+            {
+                l_index = (uint32_t)_values.size();
+                _values.push_back(1.f);
+                _rates.push_back(0.f);
+                _loops.push_back(0);
+                _events.push_back(0);
+            }
+            _values[l_index] = 1.f;
+            _rates[l_index] = 1.f / in_duration;
+            _loops[l_index] = in_looping ? 1 : 0;
+            return l_index;
+        }
+        
+        void remove(uint32_t in_index)
+        {
+            _values[in_index] = 1.f;
+            _rates[in_index] = 0.f;
+            _loops[in_index] = 0;
+            _free.push_back(in_index);
+        }
+        
+        void clear()
+        {
+            _values.clear();
+            _rates.clear();
+            _loops.clear();
+            _events.clear();
+            _free.clear();
+            _finished.clear();
+            _looped.clear();
+        }
+        
+        size_t size() const { return _values.size(); }
+        
+        void begin(uint32_t in_index) { _values[in_index] = 0.f; }
+        void reset(uint32_t in_index) { _values[in_index] = 1.f; }
+        void set_duration(uint32_t in_index, float in_duration) { _rates[in_index] = 1.f / in_duration; }
+        void set_looping(uint32_t in_index, bool in_looping) { _loops[in_index] = in_looping ? 1 : 0; }
+        
+        bool active(uint32_t in_index) const { return _values[in_index] < 1.f; }
+        bool done(uint32_t in_index) const { return _values[in_index] >= 1.f; }
+        float timer_value(uint32_t in_index) const { return _values[in_index]; }
+        
+        float map(uint32_t in_index, float in_valAtBegin, float in_valAtEnd) const
+        {
+            return mapf_unclamped(_values[in_index], 0.f, 1.f, in_valAtBegin, in_valAtEnd);
+        }
+        
+        // Direct access for batch consumers, e.g. feeding timer values into the batch easing functions.
+        const std::vector<float> & values() const { return _values; }
+        
+        // Advances every timer by in_amt, in the same units as the durations.
+        void tick(float in_amt)
+        {
+            const size_t l_count = _values.size();
+            float * __restrict l_values = _values.data();
+            const float * __restrict l_rates = _rates.data();
+            const uint32_t * __restrict l_loops = _loops.data();
+            uint32_t * __restrict l_events = _events.data();
+            // Kept free of branches and mixed-width types so it can vectorize. Compilers only if-convert the float
+            // compares when allowed to ignore FP exceptions (e.g. -fno-trapping-math, /fp:fast).
+            for(size_t i = 0; i < l_count; ++i)
+            {
+                const float l_old = l_values[i];
+                const float l_new = l_old + in_amt * l_rates[i];
+                const uint32_t l_looping = l_loops[i];
+                const uint32_t l_past_end = l_new >= 1.f;
+                const uint32_t l_was_active = l_old < 1.f;
+                const float l_wrapped = l_new - floorf(l_new);
+                const float l_clamped = l_new < 1.f ? l_new : 1.f;
+                l_values[i] = l_looping ? l_wrapped : l_clamped;
+                l_events[i] = (l_past_end & l_was_active & (l_looping ^ 1u)) | ((l_past_end & l_looping) << 1);
+            }
+            
+            _finished.clear();
+            _looped.clear();
+            for(size_t i = 0; i < l_count; ++i)
+            {
+                if(l_events[i] == 0)
+                    continue;
+                if(l_events[i] & event_finished)
+                    _finished.push_back((uint32_t)i);
+                else
+                    _looped.push_back((uint32_t)i);
+            }
+        }
+        
+        // Indices of one-shot timers that reached the end during the last tick().
+        const std::vector<uint32_t> & finished() const { return _finished; }
+        
+        // Indices of looping timers that wrapped during the last tick().
+        const std::vector<uint32_t> & looped() const { return _looped; }
+    };
 }
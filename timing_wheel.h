@@ -0,0 +1,251 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace atl
+{
+	/*
+	 timing_wheel_type: Schedules events a whole number of ticks in the future and hands them back as they expire.
+	 A replacement for polling one atl::timer per pending event: schedule and cancel are O(1), and advance()
+	 only does work for slots that hold events, so a tick with nothing due costs a few bit operations.
+
+	 Four levels of 64 slots cover delays up to 2^24 ticks; longer delays are parked in the top level and
+	 re-filed each time it comes round. Events are cascaded down a level as their slot comes due, and every
+	 event fires exactly on the tick it was scheduled for.
+
+	 Events live in pooled nodes with a free list, linked into per-slot lists by index, so once the pool has
+	 grown to the peak number of pending events nothing touches the heap. event_type is stored by value; keep
+	 it small and trivially copyable (an enum, an index, a function pointer and context) rather than a
+	 std::function, which may allocate on its own.
+	 */
+	template <typename event_type>
+	struct timing_wheel_type
+	{
+		using index_type = int32_t;
+		static constexpr index_type null_index = -1;
+		static constexpr uint32_t level_bits = 6;
+		static constexpr uint32_t slots_per_level = 1u << level_bits;
+		static constexpr uint32_t level_count = 4;
+		static constexpr uint64_t max_delay = (uint64_t(1) << (level_bits * level_count)) - 1;
+
+		// Handles carry a generation, so cancelling an event that already fired (or whose node was reused) is a safe no-op.
+		struct handle_type
+		{
+			index_type index = null_index;
+			uint32_t generation = 0;
+		};
+
+		struct node_type
+		{
+			event_type event;
+			uint64_t expiry;
+			index_type next, prev;
+			// Which list the node is linked into: a slot, the expiring list, or null_index when free.
+			index_type list;
+			uint32_t generation;
+		};
+
+		std::vector<node_type> nodes;
+		std::vector<index_type> free_nodes;
+		index_type heads[level_count * slots_per_level + 1];
+		uint64_t occupied[level_count];
+		uint64_t current_tick = 0;
+		size_t count = 0;
+
+		timing_wheel_type() { reset_lists(); }
+
+		void clear()
+		{
+			nodes.clear();
+			free_nodes.clear();
+			reset_lists();
+			current_tick = 0;
+			count = 0;
+		}
+
+		void reserve(size_t capacity) { nodes.reserve(capacity); }
+		size_t size() const { return count; }
+		bool empty() const { return count == 0; }
+		uint64_t now() const { return current_tick; }
+
+		// Fires on the advance() that reaches now() + delay_in_ticks. A delay of zero fires on the next tick.
+		handle_type schedule(uint64_t delay_in_ticks, const event_type & event)
+		{
+			index_type index;
+			if(!free_nodes.empty())
+			{
+				index = free_nodes.back();
+				free_nodes.pop_back();
+			}
+			else
+			{
+				index = static_cast<index_type>(nodes.size());
+				nodes.emplace_back();
+				nodes[index].generation = 0;
+			}
+			node_type & node = nodes[index];
+			node.event = event;
+			node.expiry = current_tick + (delay_in_ticks > 0 ? delay_in_ticks : 1);
+			file_node(index);
+			count++;
+			return {index, node.generation};
+		}
+
+		bool pending(handle_type handle) const
+		{
+			return handle.index >= 0 && handle.index < index_type(nodes.size()) &&
+				nodes[handle.index].generation == handle.generation && nodes[handle.index].list != null_index;
+		}
+
+		// Returns false if the event already fired or was cancelled.
+		bool cancel(handle_type handle)
+		{
+			if(!pending(handle)) return false;
+			unlink(handle.index);
+			release(handle.index);
+			return true;
+		}
+
+		// Ticks remaining until a pending event fires.
+		uint64_t remaining(handle_type handle) const { return nodes[handle.index].expiry - current_tick; }
+
+		/*
+		 Advance by ticks, calling callback(const event_type &) for each expiring event, in tick order.
+		 Events due on the same tick come out in no particular order. The callback may schedule and cancel freely.
+		 */
+		template <typename callback_type>
+		void advance(uint64_t ticks, callback_type && callback)
+		{
+			const uint64_t target = current_tick + ticks;
+			while(current_tick < target)
+			{
+				// Skip over empty level-0 slots, but stop at the end of the current revolution so the levels above cascade in time.
+				const uint32_t slot = uint32_t(current_tick & (slots_per_level - 1));
+				const uint64_t later_slots = slot == slots_per_level - 1 ? 0 : occupied[0] & (~uint64_t(0) << (slot + 1));
+				uint64_t next_tick = later_slots ?
+					(current_tick & ~uint64_t(slots_per_level - 1)) + uint64_t(lowest_set_bit(later_slots)) :
+					(current_tick | (slots_per_level - 1)) + 1;
+				current_tick = next_tick < target ? next_tick : target;
+
+				for(uint32_t level = level_count - 1; level > 0; --level)
+				{
+					if((current_tick & ((uint64_t(1) << (level * level_bits)) - 1)) == 0)
+						cascade(level, uint32_t(current_tick >> (level * level_bits)) & (slots_per_level - 1));
+				}
+				expire(uint32_t(current_tick & (slots_per_level - 1)), callback);
+			}
+		}
+
+	private:
+		static constexpr index_type expiring_list = index_type(level_count * slots_per_level);
+
+		static uint32_t lowest_set_bit(uint64_t bits)
+		{
+			// De Bruijn multiply: isolate the lowest bit, then look its position up from the top six bits of the product.
+			static constexpr uint8_t positions[64] =
+			{
+				0, 1, 48, 2, 57, 49, 28, 3, 61, 58, 50, 42, 38, 29, 17, 4,
+				62, 55, 59, 36, 53, 51, 43, 22, 45, 39, 33, 30, 24, 18, 12, 5,
+				63, 47, 56, 27, 60, 41, 37, 16, 54, 35, 52, 21, 44, 32, 23, 11,
+				46, 26, 40, 15, 34, 20, 31, 10, 25, 14, 19, 9, 13, 8, 7, 6
+			};
+			return positions[((bits & (0 - bits)) * 0x03f79d71b4cb0a89ull) >> 58];
+		}
+
+		void reset_lists()
+		{
+			for(auto & head : heads) head = null_index;
+			for(auto & bits : occupied) bits = 0;
+		}
+
+		void file_node(index_type index)
+		{
+			const uint64_t expiry = nodes[index].expiry;
+			uint64_t delay = expiry - current_tick;
+			uint64_t slot_time = expiry;
+			if(delay > max_delay)
+			{
+				// Park in the farthest top-level slot; it is re-filed when that slot cascades.
+				delay = max_delay;
+				slot_time = current_tick + max_delay;
+			}
+			uint32_t level = 0;
+			while(delay >= (uint64_t(1) << ((level + 1) * level_bits))) level++;
+			const uint32_t slot = uint32_t(slot_time >> (level * level_bits)) & (slots_per_level - 1);
+			link(index, index_type(level * slots_per_level + slot));
+			occupied[level] |= uint64_t(1) << slot;
+		}
+
+		void link(index_type index, index_type list)
+		{
+			node_type & node = nodes[index];
+			node.list = list;
+			node.prev = null_index;
+			node.next = heads[list];
+			if(node.next != null_index) nodes[node.next].prev = index;
+			heads[list] = index;
+		}
+
+		void unlink(index_type index)
+		{
+			node_type & node = nodes[index];
+			if(node.prev != null_index) nodes[node.prev].next = node.next;
+			else heads[node.list] = node.next;
+			if(node.next != null_index) nodes[node.next].prev = node.prev;
+			if(node.list != expiring_list && heads[node.list] == null_index)
+			{
+				const uint32_t level = uint32_t(node.list) / slots_per_level;
+				occupied[level] &= ~(uint64_t(1) << (uint32_t(node.list) % slots_per_level));
+			}
+			node.list = null_index;
+		}
+
+		void release(index_type index)
+		{
+			nodes[index].generation++;
+			free_nodes.push_back(index);
+			count--;
+		}
+
+		// Moves a slot's list aside (to the expiring list) so nodes can be unlinked one at a time while callbacks run.
+		void detach_slot(uint32_t level, uint32_t slot)
+		{
+			const index_type list = index_type(level * slots_per_level + slot);
+			index_type index = heads[list];
+			heads[expiring_list] = index;
+			heads[list] = null_index;
+			occupied[level] &= ~(uint64_t(1) << slot);
+			for(; index != null_index; index = nodes[index].next)
+				nodes[index].list = expiring_list;
+		}
+
+		void cascade(uint32_t level, uint32_t slot)
+		{
+			detach_slot(level, slot);
+			while(heads[expiring_list] != null_index)
+			{
+				const index_type index = heads[expiring_list];
+				unlink(index);
+				file_node(index);
+			}
+		}
+
+		template <typename callback_type>
+		void expire(uint32_t slot, callback_type & callback)
+		{
+			if(heads[slot] == null_index) return;
+			detach_slot(0, slot);
+			while(heads[expiring_list] != null_index)
+			{
+				const index_type index = heads[expiring_list];
+				unlink(index);
+				// Copy out and free the node first, so the callback can schedule into it or cancel any other event.
+				const event_type event = nodes[index].event;
+				release(index);
+				callback(event);
+			}
+		}
+	};
+}